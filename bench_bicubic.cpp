@@ -0,0 +1,91 @@
+#include "bicubic.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+// Microbenchmark for the parts of `bicubic_s` used by `eik`: building
+// a cell (`bicubic_set_data`, once per cell) and getting the cubics
+// along one of its edges, oriented the way `tri` needs them (once per
+// triangle update). The latter is timed both using the separate
+// `bicubic_get_*_on_edge` and `cubic_reverse_on_unit_interval`
+// functions, and using `bicubic_get_cubics_on_edge` (which is what
+// `tri` does). Compare this with the same program built with
+// BICUBIC_STORAGE=VERT_BICUBIC_STORAGE (see bench_bicubic.sh).
+
+#define NUM_CELLS 4096
+#define NUM_REPS 1000
+
+static dbl toc(struct timespec const *tic) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (t.tv_sec - tic->tv_sec) + (t.tv_nsec - tic->tv_nsec)/1e9;
+}
+
+int main() {
+  dmat44 *data = (dmat44 *)malloc(NUM_CELLS*sizeof(dmat44));
+  bicubic_s *bicubics = (bicubic_s *)malloc(NUM_CELLS*sizeof(bicubic_s));
+  for (int k = 0; k < NUM_CELLS; ++k) {
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        data[k].data[i][j] = drand48();
+      }
+    }
+  }
+
+  // Accumulate the results so that none of the work can be skipped
+  dbl sum = 0;
+
+  struct timespec tic;
+  clock_gettime(CLOCK_MONOTONIC, &tic);
+  for (int r = 0; r < NUM_REPS; ++r) {
+    for (int k = 0; k < NUM_CELLS; ++k) {
+      data[k].data[0][0] += 1e-16;
+      bicubic_set_data(&bicubics[k], data[k]);
+    }
+    sum += bicubic_f(&bicubics[r % NUM_CELLS], (dvec2) {0.5, 0.5});
+  }
+  dbl t_build = toc(&tic);
+
+  clock_gettime(CLOCK_MONOTONIC, &tic);
+  for (int r = 0; r < NUM_REPS; ++r) {
+    for (int k = 0; k < NUM_CELLS; ++k) {
+      bicubic_variable var = (k + r) & 1 ? LAMBDA : MU;
+      int edge = ((k + r) >> 1) & 1;
+      bool reverse = ((k + r) >> 2) & 1;
+      cubic_s T = bicubic_get_f_on_edge(&bicubics[k], var, edge);
+      cubic_s Tx = bicubic_get_fx_on_edge(&bicubics[k], var, edge);
+      cubic_s Ty = bicubic_get_fy_on_edge(&bicubics[k], var, edge);
+      if (reverse) {
+        cubic_reverse_on_unit_interval(&T);
+        cubic_reverse_on_unit_interval(&Tx);
+        cubic_reverse_on_unit_interval(&Ty);
+      }
+      sum += T.a.data[r & 3] + Tx.a.data[r & 3] + Ty.a.data[r & 3];
+    }
+  }
+  dbl t_edges = toc(&tic);
+
+  clock_gettime(CLOCK_MONOTONIC, &tic);
+  for (int r = 0; r < NUM_REPS; ++r) {
+    for (int k = 0; k < NUM_CELLS; ++k) {
+      bicubic_variable var = (k + r) & 1 ? LAMBDA : MU;
+      int edge = ((k + r) >> 1) & 1;
+      bool reverse = ((k + r) >> 2) & 1;
+      cubic_s T, Tx, Ty;
+      bicubic_get_cubics_on_edge(&bicubics[k], var, edge, reverse,
+                                 &T, &Tx, &Ty);
+      sum += T.a.data[r & 3] + Tx.a.data[r & 3] + Ty.a.data[r & 3];
+    }
+  }
+  dbl t_tri = toc(&tic);
+
+  dbl n = (dbl)NUM_CELLS*NUM_REPS;
+  printf("bicubic_set_data: %g ns/cell\n", 1e9*t_build/n);
+  printf("bicubic_get_*_on_edge: %g ns/triangle update\n", 1e9*t_edges/n);
+  printf("bicubic_get_cubics_on_edge: %g ns/triangle update\n", 1e9*t_tri/n);
+  printf("(checksum: %g)\n", sum);
+
+  free(data);
+  free(bicubics);
+}
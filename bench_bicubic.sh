@@ -0,0 +1,23 @@
+#!/usr/bin/env sh
+
+# Compare storing bicubics as their coefficients (./scratch) with
+# storing their vertex data (./scratch_vert, see VERT_BICUBIC_STORAGE
+# in def.h). The bench_bicubic microbenchmark times the bicubic
+# operations done for each cell and each triangle update on their
+# own, and the scratch runs report the overall number of updates per
+# second. Set NS to change the grid sizes.
+
+NS=${NS:-"513 1025 2049"}
+
+for exe in bench_bicubic bench_bicubic_vert; do
+    echo "$exe:"
+    ./$exe | sed 's/^/  /'
+done
+
+for N in $NS; do
+    echo "N = $N"
+    for exe in scratch scratch_vert; do
+        echo "  $exe:"
+        ./$exe $N -q 2>&1 | sed 's/^/    /'
+    done
+done
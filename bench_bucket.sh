@@ -0,0 +1,20 @@
+#!/usr/bin/env sh
+
+# Compare the running time and accuracy of `eik_solve` on the problem
+# in scratch.cpp when the heap is replaced by bucket queues of
+# different widths (given as multiples of h*s_min). Set PMIN and PMAX
+# to change the range of grid sizes N = 2^p + 1.
+
+PMIN=${PMIN:-9}
+PMAX=${PMAX:-12}
+
+for p in `seq $PMIN $PMAX`; do
+    N=$(((1 << $p) + 1))
+    echo "N = 2^$p + 1 = $N"
+    echo "  heap:"
+    ./scratch $N -q | sed 's/^/    /'
+    for b in 0.1 0.3 0.7071; do
+        echo "  buckets (width = $b*h*s_min):"
+        ./scratch $N -q -b $b | sed 's/^/    /'
+    done
+done
@@ -0,0 +1,16 @@
+#!/usr/bin/env sh
+
+# Compare storing a bicubic for every cell (./scratch) with only
+# storing the cells in the band behind the front (./scratch_band, see
+# BAND_CELL_STORAGE in def.h). Each run reports its peak memory
+# usage. Set NS to change the grid sizes.
+
+NS=${NS:-"1025 2049 4097 8193"}
+
+for N in $NS; do
+    echo "N = $N"
+    for exe in scratch scratch_band; do
+        echo "  $exe:"
+        ./$exe $N -q 2>&1 | sed 's/^/    /'
+    done
+done
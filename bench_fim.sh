@@ -0,0 +1,24 @@
+#!/usr/bin/env sh
+
+# Compare `eik_solve` with `eik_solve_fim` on the problem in
+# scratch.cpp, using both its smooth slowness and a rough one (see
+# `s_rough`). Set OMP_NUM_THREADS to change the number of threads
+# used, and PMIN and PMAX to change the range of grid sizes N = 2^p
+# + 1.
+
+PMIN=${PMIN:-8}
+PMAX=${PMAX:-11}
+
+for p in `seq $PMIN $PMAX`; do
+    N=$(((1 << $p) + 1))
+    echo "N = 2^$p + 1 = $N"
+    for r in "" "-r"; do
+        if [ -z "$r" ]; then
+            echo "  smooth:"
+        else
+            echo "  rough:"
+        fi
+        ./scratch $N -q $r | sed 's/^/    /'
+        ./scratch $N -q -f $r | sed 's/^/    /'
+    done
+done
@@ -0,0 +1,16 @@
+#!/usr/bin/env sh
+
+# Time `eik_solve` on the problem in scratch.cpp using heaps with
+# different arities. Set PMIN and PMAX to change the range of grid
+# sizes N = 2^p + 1.
+
+PMIN=${PMIN:-7}
+PMAX=${PMAX:-11}
+
+for p in `seq $PMIN $PMAX`; do
+    N=$(((1 << $p) + 1))
+    for a in 2 4 8; do
+        printf "N = 2^%d + 1 = %d, arity = %d: " $p $N $a
+        ./scratch $N -a $a -q
+    done
+done
@@ -0,0 +1,21 @@
+#!/usr/bin/env sh
+
+# Compare the number of updates per second done by `eik_solve` on the
+# problem in scratch.cpp when F4 is minimized starting from a finite
+# difference Hessian (-H), from the exact Hessian, and using Newton's
+# method (-n). Set PMIN and PMAX to change the range of grid sizes
+# N = 2^p + 1.
+
+PMIN=${PMIN:-7}
+PMAX=${PMAX:-10}
+
+for p in `seq $PMIN $PMAX`; do
+    N=$(((1 << $p) + 1))
+    echo "N = 2^$p + 1 = $N"
+    echo "  finite difference Hessian:"
+    ./scratch $N -q -H | sed 's/^/    /'
+    echo "  exact Hessian:"
+    ./scratch $N -q | sed 's/^/    /'
+    echo "  Newton's method:"
+    ./scratch $N -q -n | sed 's/^/    /'
+done
@@ -0,0 +1,24 @@
+#!/usr/bin/env sh
+
+# Compare storing the grid in row-major order (./scratch) with
+# storing it in tiles (./scratch_tiled, see TILED_ORDERING in
+# def.h). If perf is installed, the number of cache and dTLB misses
+# is reported for each run, too. Set NS to change the grid sizes.
+
+NS=${NS:-"4097 8193"}
+EVENTS=cache-references,cache-misses,dTLB-load-misses
+
+if command -v perf > /dev/null; then
+    RUN="perf stat -e $EVENTS"
+else
+    echo "perf not found: only reporting running times"
+    RUN=
+fi
+
+for N in $NS; do
+    echo "N = $N"
+    for exe in scratch scratch_tiled; do
+        echo "  $exe:"
+        $RUN ./$exe $N -q 2>&1 | sed 's/^/    /'
+    done
+done
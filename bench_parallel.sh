@@ -0,0 +1,43 @@
+#!/usr/bin/env sh
+
+# Compare `eik_solve` with `eik_solve_parallel` on the problem in
+# scratch.cpp for a few different numbers of tiles, and print the
+# wall-clock speedup of each over `eik_solve` (which is run without
+# warm starts, like the tiles). Set OMP_NUM_THREADS to change the
+# number of threads used, NTILES to change the number of tiles along
+# each side of the grid, and PMIN and PMAX to change the range of
+# grid sizes N = 2^p + 1.
+#
+# With a single point source, the front only crosses a few tiles at a
+# time, and a tile is solved again (from the level where its halo
+# changed) each time a neighbor's solution changes, so the tiles do
+# more updates than `eik_solve`. For N = 257, they did 2.6x (2 x 2),
+# 2.7x (4 x 4), and 4.1x (8 x 8) as many, and on a machine with a
+# single core, the speedups were 0.38x, 0.35x, and 0.22x. With more
+# cores, the speedup is at most the number of threads divided by
+# these ratios.
+
+PMIN=${PMIN:-8}
+PMAX=${PMAX:-11}
+NTILES=${NTILES:-"2 4 8"}
+
+solve_time() {
+    sed -n 's/^eik_solve[a-z_]*: \(.*\) s$/\1/p'
+}
+
+for p in `seq $PMIN $PMAX`; do
+    N=$(((1 << $p) + 1))
+    echo "N = 2^$p + 1 = $N"
+    echo "  serial:"
+    out=`./scratch $N -q -w`
+    echo "$out" | sed 's/^/    /'
+    t_serial=`echo "$out" | solve_time`
+    for t in $NTILES; do
+        echo "  $t x $t tiles:"
+        out=`./scratch $N -q -p $t`
+        echo "$out" | sed 's/^/    /'
+        t_parallel=`echo "$out" | solve_time`
+        echo "$t_serial $t_parallel" | \
+            awk '{ printf "    speedup: %.2fx\n", $1/$2 }'
+    done
+done
@@ -0,0 +1,26 @@
+#!/usr/bin/env sh
+
+# Compare `eik_solve` with `eik_solve_sweep` on the problem in
+# scratch.cpp, sweeping serially and with a few different numbers of
+# tiles. Set OMP_NUM_THREADS to change the number of threads used,
+# TOL to change the tolerance, NTILES to change the number of tiles
+# along each side of the grid, and PMIN and PMAX to change the range
+# of grid sizes N = 2^p + 1.
+
+PMIN=${PMIN:-7}
+PMAX=${PMAX:-10}
+TOL=${TOL:-1e-8}
+NTILES=${NTILES:-"4 8"}
+
+for p in `seq $PMIN $PMAX`; do
+    N=$(((1 << $p) + 1))
+    echo "N = 2^$p + 1 = $N"
+    echo "  eik_solve:"
+    ./scratch $N -q | sed 's/^/    /'
+    echo "  serial sweeps:"
+    ./scratch $N -q -s $TOL | sed 's/^/    /'
+    for t in $NTILES; do
+        echo "  $t x $t tiles:"
+        ./scratch $N -q -s $TOL -p $t | sed 's/^/    /'
+    done
+done
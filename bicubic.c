@@ -20,6 +20,208 @@ static dmat44 V_inv_tr = {
   }
 };
 
+#if BICUBIC_STORAGE == VERT_BICUBIC_STORAGE
+
+/**
+ * The cubic Hermite basis on [0, 1], in the same order as the rows
+ * (and columns) of the data matrix: the basis functions for the
+ * values at 0 and 1, followed by those for the derivatives at 0 and
+ * 1. These are the same as `dvec4_dmat44_mul(dvec4_m(t), V_inv)`.
+ */
+static dvec4 hermite(dbl t) {
+  dbl t_sq = t*t, t_cu = t_sq*t;
+  return (dvec4) {
+    .data = {
+      1 - 3*t_sq + 2*t_cu,
+      3*t_sq - 2*t_cu,
+      t - 2*t_sq + t_cu,
+      t_cu - t_sq
+    }
+  };
+}
+
+static dvec4 hermite_d(dbl t) {
+  dbl t_sq = t*t;
+  return (dvec4) {
+    .data = {
+      6*t_sq - 6*t,
+      6*t - 6*t_sq,
+      1 - 4*t + 3*t_sq,
+      3*t_sq - 2*t
+    }
+  };
+}
+
+static dvec4 hermite_d2(dbl t) {
+  return (dvec4) {
+    .data = {
+      12*t - 6,
+      6 - 12*t,
+      6*t - 4,
+      6*t - 2
+    }
+  };
+}
+
+void bicubic_set_data(bicubic_s *bicubic, dmat44 data) {
+  bicubic->data = data;
+}
+
+void bicubic_set_data_from_ptr(bicubic_s *bicubic, dbl const *data_ptr) {
+  memcpy((void *)bicubic->data.data, (void *)data_ptr, 16*sizeof(dbl));
+}
+
+dmat44 bicubic_get_A(bicubic_s const *bicubic) {
+  return dmat44_dmat44_mul(dmat44_dmat44_mul(V_inv, bicubic->data), V_inv_tr);
+}
+
+/**
+ * Get the coefficients of the cubic whose values and derivatives at
+ * 0 and 1 are `p[0]`, `p[1]`, `p[2]`, and `p[3]` (i.e., compute
+ * `dmat44_dvec4_mul(V_inv, p)`, but without the zeros).
+ */
+static cubic_s hermite_to_cubic(dbl const p[4]) {
+  return (cubic_s) {
+    .a = {
+      .data = {
+        p[0],
+        p[2],
+        3*(p[1] - p[0]) - 2*p[2] - p[3],
+        2*(p[0] - p[1]) + p[2] + p[3]
+      }
+    }
+  };
+}
+
+/**
+ * Get the values and derivatives along the edge `edge` of the cell
+ * with `var` varying. With `d` = 0, these are the values of `f`, and
+ * with `d` = 1 they're the values of the cross derivative (`fy` if
+ * `var` is LAMBDA and `fx` if it's MU). If `reverse` is true, the
+ * cubic is reversed on [0, 1], which just means swapping the
+ * endpoints and negating the derivatives.
+ */
+static cubic_s get_cubic(dmat44 const *data, bicubic_variable var, int edge,
+                         int d, bool reverse) {
+  int k = 2*d + edge;
+  dbl p[4];
+  for (int i = 0; i < 4; ++i) {
+    p[i] = var == LAMBDA ? data->data[i][k] : data->data[k][i];
+  }
+  if (reverse) {
+    dbl q[4] = {p[1], p[0], -p[3], -p[2]};
+    return hermite_to_cubic(q);
+  }
+  return hermite_to_cubic(p);
+}
+
+static cubic_s differentiate(cubic_s cubic) {
+  return (cubic_s) {
+    .a = {.data = {cubic.a.data[1], 2*cubic.a.data[2], 3*cubic.a.data[3], 0}}
+  };
+}
+
+cubic_s
+bicubic_get_f_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge) {
+  return get_cubic(&bicubic->data, var, edge, 0, false);
+}
+
+cubic_s
+bicubic_get_fx_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge) {
+  return var == LAMBDA ?
+    differentiate(get_cubic(&bicubic->data, var, edge, 0, false)) :
+    get_cubic(&bicubic->data, var, edge, 1, false);
+}
+
+cubic_s
+bicubic_get_fy_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge) {
+  return var == LAMBDA ?
+    get_cubic(&bicubic->data, var, edge, 1, false) :
+    differentiate(get_cubic(&bicubic->data, var, edge, 0, false));
+}
+
+/**
+ * Get the cubics giving `f`, `fx`, and `fy` along the edge `edge`
+ * with `var` varying, reversed on [0, 1] if `reverse` is true. This
+ * is what a triangle update needs, and is cheaper than calling each
+ * of the `bicubic_get_*_on_edge` functions and reversing the results.
+ */
+void bicubic_get_cubics_on_edge(bicubic_s const *bicubic,
+                                bicubic_variable var, int edge, bool reverse,
+                                cubic_s *f, cubic_s *fx, cubic_s *fy) {
+  *f = get_cubic(&bicubic->data, var, edge, 0, reverse);
+
+  // The derivative along the edge is the derivative of `f`, except
+  // that reversing the edge flips its sign
+  cubic_s along = differentiate(*f);
+  if (reverse) {
+    for (int i = 0; i < 4; ++i) {
+      along.a.data[i] = -along.a.data[i];
+    }
+  }
+
+  cubic_s cross = get_cubic(&bicubic->data, var, edge, 1, reverse);
+
+  *fx = var == LAMBDA ? along : cross;
+  *fy = var == LAMBDA ? cross : along;
+}
+
+dbl bicubic_f(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    hermite(cc.x),
+    dmat44_dvec4_mul(bicubic->data, hermite(cc.y))
+  );
+}
+
+dbl bicubic_fx(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    hermite_d(cc.x),
+    dmat44_dvec4_mul(bicubic->data, hermite(cc.y))
+  );
+}
+
+dbl bicubic_fy(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    hermite(cc.x),
+    dmat44_dvec4_mul(bicubic->data, hermite_d(cc.y))
+  );
+}
+
+dbl bicubic_fxy(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    hermite_d(cc.x),
+    dmat44_dvec4_mul(bicubic->data, hermite_d(cc.y))
+  );
+}
+
+dbl bicubic_fxx(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    hermite_d2(cc.x),
+    dmat44_dvec4_mul(bicubic->data, hermite(cc.y))
+  );
+}
+
+dbl bicubic_fyy(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    hermite(cc.x),
+    dmat44_dvec4_mul(bicubic->data, hermite_d2(cc.y))
+  );
+}
+
+jet_s bicubic_get_jet(bicubic_s const *bicubic, dvec2 cc) {
+  dvec4 b_x = hermite(cc.x), db_x = hermite_d(cc.x);
+  dvec4 data_b_y = dmat44_dvec4_mul(bicubic->data, hermite(cc.y));
+  dvec4 data_db_y = dmat44_dvec4_mul(bicubic->data, hermite_d(cc.y));
+  return (jet_s) {
+    .f = dvec4_dot(b_x, data_b_y),
+    .fx = dvec4_dot(db_x, data_b_y),
+    .fy = dvec4_dot(b_x, data_db_y),
+    .fxy = dvec4_dot(db_x, data_db_y)
+  };
+}
+
+#else
+
 static dmat44 D = {
   .data = {
     {0, 0, 0, 0},
@@ -47,6 +249,10 @@ void bicubic_set_data_from_ptr(bicubic_s *bicubic, dbl const *data_ptr) {
   memcpy((void *)bicubic->A.data, (void *)data_ptr, 16*sizeof(dbl));
 }
 
+dmat44 bicubic_get_A(bicubic_s const *bicubic) {
+  return bicubic->A;
+}
+
 static dvec4 restrict_A(dmat44 A, bicubic_variable var, int edge) {
   return var == LAMBDA ?
     dmat44_dvec4_mul(A, edge == 0 ? dvec4_e1() : dvec4_one()) :
@@ -79,6 +285,22 @@ bicubic_get_fy_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge)
   return cubic;
 }
 
+/**
+ * See the VERT_BICUBIC_STORAGE version above.
+ */
+void bicubic_get_cubics_on_edge(bicubic_s const *bicubic,
+                                bicubic_variable var, int edge, bool reverse,
+                                cubic_s *f, cubic_s *fx, cubic_s *fy) {
+  *f = bicubic_get_f_on_edge(bicubic, var, edge);
+  *fx = bicubic_get_fx_on_edge(bicubic, var, edge);
+  *fy = bicubic_get_fy_on_edge(bicubic, var, edge);
+  if (reverse) {
+    cubic_reverse_on_unit_interval(f);
+    cubic_reverse_on_unit_interval(fx);
+    cubic_reverse_on_unit_interval(fy);
+  }
+}
+
 dbl bicubic_f(bicubic_s const *bicubic, dvec2 cc) {
   return dvec4_dot(
     dvec4_m(cc.x),
@@ -107,6 +329,39 @@ dbl bicubic_fxy(bicubic_s const *bicubic, dvec2 cc) {
   );
 }
 
+dbl bicubic_fxx(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    dvec4_d2m(cc.x),
+    dmat44_dvec4_mul(bicubic->A, dvec4_m(cc.y))
+  );
+}
+
+dbl bicubic_fyy(bicubic_s const *bicubic, dvec2 cc) {
+  return dvec4_dot(
+    dvec4_m(cc.x),
+    dmat44_dvec4_mul(bicubic->A, dvec4_d2m(cc.y))
+  );
+}
+
+/**
+ * Evaluate f, fx, fy, and fxy at `cc` all at once. This only takes
+ * two matrix-vector products, instead of the four it takes to call
+ * each of `bicubic_f`, `bicubic_fx`, etc.
+ */
+jet_s bicubic_get_jet(bicubic_s const *bicubic, dvec2 cc) {
+  dvec4 m_x = dvec4_m(cc.x), dm_x = dvec4_dm(cc.x);
+  dvec4 A_m_y = dmat44_dvec4_mul(bicubic->A, dvec4_m(cc.y));
+  dvec4 A_dm_y = dmat44_dvec4_mul(bicubic->A, dvec4_dm(cc.y));
+  return (jet_s) {
+    .f = dvec4_dot(m_x, A_m_y),
+    .fx = dvec4_dot(dm_x, A_m_y),
+    .fy = dvec4_dot(m_x, A_dm_y),
+    .fxy = dvec4_dot(dm_x, A_dm_y)
+  };
+}
+
+#endif
+
 /**
  * TODO: move this into the `bicubic` module, add some unit tests,
  * etc.
@@ -137,10 +392,20 @@ dvec4 interpolate_fxy_at_verts(dvec4 fx, dvec4 fy, dbl h) {
   );
 }
 
+/**
+ * Use `BICUBIC_M(bicubic)` to get the matrix stored in `bicubic`,
+ * regardless of BICUBIC_STORAGE.
+ */
+#if BICUBIC_STORAGE == VERT_BICUBIC_STORAGE
+#define BICUBIC_M(bicubic) ((bicubic)->data)
+#else
+#define BICUBIC_M(bicubic) ((bicubic)->A)
+#endif
+
 bool bicubic_valid(bicubic_s const *bicubic) {
   for (int i = 0; i < 4; ++i) {
     for (int j = 0; j < 4; ++j) {
-      if (!isfinite(bicubic->A.data[i][j])) {
+      if (!isfinite(BICUBIC_M(bicubic).data[i][j])) {
         return false;
       }
     }
@@ -151,7 +416,7 @@ bool bicubic_valid(bicubic_s const *bicubic) {
 void bicubic_invalidate(bicubic_s *bicubic) {
   for (int i = 0; i < 4; ++i) {
     for (int j = 0; j < 4; ++j) {
-      bicubic->A.data[i][j] = NAN;
+      BICUBIC_M(bicubic).data[i][j] = NAN;
     }
   }
 }
@@ -7,23 +7,41 @@ extern "C" {
 #include <stdbool.h>
 
 #include "cubic.h"
+#include "jet.h"
 #include "mat.h"
 
 typedef enum {LAMBDA, MU} bicubic_variable;
 
+/**
+ * With COEF_BICUBIC_STORAGE, `A` holds the coefficients of the
+ * bicubic in the monomial basis. With VERT_BICUBIC_STORAGE, `data`
+ * holds the data matrix passed to `bicubic_set_data` (see
+ * BICUBIC_STORAGE in def.h).
+ */
 typedef struct bicubic {
+#if BICUBIC_STORAGE == VERT_BICUBIC_STORAGE
+  dmat44 data;
+#else
   dmat44 A;
+#endif
 } bicubic_s;
 
 void bicubic_set_data(bicubic_s *bicubic, dmat44 data);
 void bicubic_set_data_from_ptr(bicubic_s *bicubic, dbl const *data_ptr);
+dmat44 bicubic_get_A(bicubic_s const *bicubic);
 cubic_s bicubic_get_f_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge);
 cubic_s bicubic_get_fx_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge);
 cubic_s bicubic_get_fy_on_edge(bicubic_s const *bicubic, bicubic_variable var, int edge);
+void bicubic_get_cubics_on_edge(bicubic_s const *bicubic,
+                                bicubic_variable var, int edge, bool reverse,
+                                cubic_s *f, cubic_s *fx, cubic_s *fy);
 dbl bicubic_f(bicubic_s const *bicubic, dvec2 cc);
 dbl bicubic_fx(bicubic_s const *bicubic, dvec2 cc);
 dbl bicubic_fy(bicubic_s const *bicubic, dvec2 cc);
 dbl bicubic_fxy(bicubic_s const *bicubic, dvec2 cc);
+dbl bicubic_fxx(bicubic_s const *bicubic, dvec2 cc);
+dbl bicubic_fyy(bicubic_s const *bicubic, dvec2 cc);
+jet_s bicubic_get_jet(bicubic_s const *bicubic, dvec2 cc);
 dvec4 interpolate_fxy_at_verts(dvec4 fx, dvec4 fy, dbl h);
 bool bicubic_valid(bicubic_s const *bicubic);
 void bicubic_invalidate(bicubic_s *bicubic);
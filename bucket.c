@@ -0,0 +1,273 @@
+#include "bucket.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * The number of buckets in the active window. Elements whose keys
+ * lie past the end of the window are kept in a separate overflow
+ * list until the window is exhausted.
+ */
+#define NUM_BUCKETS 256
+
+#define OVERFLOW NUM_BUCKETS
+
+/**
+ * An "untidy" bucket queue (a.k.a. Dial's algorithm): an element
+ * with key `T` is stored in the bucket with index `floor(T/width)`,
+ * and each bucket is a doubly linked list of elements in no
+ * particular order. Inserting an element, changing its key, and
+ * popping the front are all O(1), and scanning for the next
+ * nonempty bucket is amortized O(1) as long as the keys that are
+ * popped are nondecreasing (which is the case for `eik`).
+ *
+ * The price is that elements are only ordered up to the bucket
+ * width: `bucket_front` returns *some* element of the lowest
+ * nonempty bucket, which isn't necessarily the element with the
+ * smallest key. A node's value is at least `h*s_min/sqrt2` larger
+ * than the values of the nodes it's updated from, so if `width <=
+ * h*s_min/sqrt2`, two nodes in the same bucket can't depend on each
+ * other and the order they're popped in shouldn't matter. On the
+ * problem in scratch.cpp (see bench_bucket.sh), this is borne out:
+ * the error is the same as with the heap. With larger widths, a node
+ * can be frozen before one of its upwind neighbors, which introduces
+ * an O(width) error, and in practice makes the triangle updates
+ * fail. Since most of the time spent by `eik_solve` goes into
+ * updates rather than the heap, the speedup is modest.
+ *
+ * The window of buckets is only opened when `bucket_front` is
+ * called, starting at the bucket containing the smallest key. Until
+ * then (e.g., while the initial TRIAL nodes are being added), all
+ * elements are put into the overflow list, so they may be inserted
+ * in any order. Afterwards, if a key decreases below the current
+ * bucket (which can only happen if the keys aren't monotone), the
+ * element is put into the current bucket.
+ *
+ * The positions reported through `setpos` are indices into a pool of
+ * list nodes. They stay fixed while an element is in the queue.
+ */
+typedef struct bucket_node {
+  dbl key;
+  int ind;
+  int bucket;
+  int prev, next;
+} bucket_node_s;
+
+struct bucket {
+  dbl width;
+  dbl base; // index of the first bucket in the window
+  int cur; // offset of the lowest possibly nonempty bucket, or
+           // NUM_BUCKETS if the window isn't open
+  int head[NUM_BUCKETS + 1]; // last entry is the overflow list
+  int size;
+  int capacity;
+  int free;
+  bucket_node_s *nodes;
+  value_f value;
+  setpos_f setpos;
+  void *context;
+};
+
+void bucket_alloc(bucket_s **bucket) {
+  *bucket = malloc(sizeof(bucket_s));
+  assert(*bucket != NULL);
+}
+
+void bucket_dealloc(bucket_s **bucket) {
+  free(*bucket);
+  *bucket = NULL;
+}
+
+static void add_free_nodes(bucket_s *bucket, int start) {
+  for (int pos = start; pos < bucket->capacity; ++pos) {
+    bucket->nodes[pos].ind = NO_INDEX;
+    bucket->nodes[pos].next = pos + 1 < bucket->capacity ? pos + 1 : NO_INDEX;
+  }
+  bucket->free = start;
+}
+
+void bucket_init(bucket_s *bucket, int capacity, dbl width, value_f value,
+                 setpos_f setpos, void *context) {
+  assert(capacity > 0);
+  assert(width > 0);
+
+  bucket->width = width;
+  bucket->base = 0;
+  bucket->cur = NUM_BUCKETS;
+  for (int i = 0; i <= NUM_BUCKETS; ++i) {
+    bucket->head[i] = NO_INDEX;
+  }
+  bucket->size = 0;
+  bucket->capacity = capacity;
+  bucket->nodes = malloc(capacity*sizeof(bucket_node_s));
+  assert(bucket->nodes != NULL);
+  add_free_nodes(bucket, 0);
+  bucket->value = value;
+  bucket->setpos = setpos;
+  bucket->context = context;
+}
+
+void bucket_deinit(bucket_s *bucket) {
+  free(bucket->nodes);
+  bucket->nodes = NULL;
+}
+
+static void grow(bucket_s *bucket) {
+  int capacity = bucket->capacity;
+  bucket->capacity *= 2;
+  bucket->nodes = realloc(bucket->nodes,
+                          bucket->capacity*sizeof(bucket_node_s));
+  assert(bucket->nodes != NULL);
+  add_free_nodes(bucket, capacity);
+}
+
+/**
+ * Get the offset into the window of the bucket that `key` belongs in.
+ */
+static int get_bucket(bucket_s const *bucket, dbl key) {
+  dbl k = floor(key/bucket->width) - bucket->base;
+  if (k < bucket->cur) {
+    return bucket->cur;
+  }
+  return k < NUM_BUCKETS ? (int)k : OVERFLOW;
+}
+
+static void link_node(bucket_s *bucket, int pos, int b) {
+  bucket_node_s *node = &bucket->nodes[pos];
+  node->bucket = b;
+  node->prev = NO_INDEX;
+  node->next = bucket->head[b];
+  if (node->next != NO_INDEX) {
+    bucket->nodes[node->next].prev = pos;
+  }
+  bucket->head[b] = pos;
+}
+
+static void unlink_node(bucket_s *bucket, int pos) {
+  bucket_node_s *node = &bucket->nodes[pos];
+  if (node->prev == NO_INDEX) {
+    bucket->head[node->bucket] = node->next;
+  } else {
+    bucket->nodes[node->prev].next = node->next;
+  }
+  if (node->next != NO_INDEX) {
+    bucket->nodes[node->next].prev = node->prev;
+  }
+}
+
+/**
+ * Move the window so that it starts at the bucket containing the
+ * smallest key in the overflow list, and move the elements which now
+ * fit in the window out of the overflow list.
+ */
+static void rebase(bucket_s *bucket) {
+  assert(bucket->head[OVERFLOW] != NO_INDEX);
+
+  dbl min_key = INFINITY;
+  for (int pos = bucket->head[OVERFLOW]; pos != NO_INDEX;
+       pos = bucket->nodes[pos].next) {
+    min_key = fmin(min_key, bucket->nodes[pos].key);
+  }
+
+  // If only infinite keys are left, put them all in the first bucket
+  // and leave them unordered.
+  bucket->base = isfinite(min_key) ? floor(min_key/bucket->width) : INFINITY;
+  bucket->cur = 0;
+
+  int pos = bucket->head[OVERFLOW], next, b;
+  bucket->head[OVERFLOW] = NO_INDEX;
+  while (pos != NO_INDEX) {
+    next = bucket->nodes[pos].next;
+    b = isfinite(bucket->base) ? get_bucket(bucket, bucket->nodes[pos].key) : 0;
+    link_node(bucket, pos, b);
+    pos = next;
+  }
+}
+
+void bucket_insert_with_key(bucket_s *bucket, int ind, dbl key) {
+  if (bucket->free == NO_INDEX) {
+    grow(bucket);
+  }
+
+  int pos = bucket->free;
+  bucket->free = bucket->nodes[pos].next;
+
+  bucket->nodes[pos].key = key;
+  bucket->nodes[pos].ind = ind;
+  link_node(bucket, pos, get_bucket(bucket, key));
+  bucket->setpos(bucket->context, ind, pos);
+
+  ++bucket->size;
+}
+
+void bucket_insert(bucket_s *bucket, int ind) {
+  bucket_insert_with_key(bucket, ind, bucket->value(bucket->context, ind));
+}
+
+void bucket_swim(bucket_s *bucket, int pos) {
+  assert(pos >= 0);
+  assert(pos < bucket->capacity);
+
+  int ind = bucket->nodes[pos].ind;
+  bucket_update_key(bucket, pos, bucket->value(bucket->context, ind));
+}
+
+void bucket_update_key(bucket_s *bucket, int pos, dbl key) {
+  assert(pos >= 0);
+  assert(pos < bucket->capacity);
+  assert(bucket->nodes[pos].ind != NO_INDEX);
+
+  bucket->nodes[pos].key = key;
+  int b = get_bucket(bucket, key);
+  if (b != bucket->nodes[pos].bucket) {
+    unlink_node(bucket, pos);
+    link_node(bucket, pos, b);
+  }
+}
+
+int bucket_front(bucket_s *bucket) {
+  assert(bucket->size > 0);
+
+  for (;;) {
+    if (bucket->cur == NUM_BUCKETS) {
+      rebase(bucket);
+    }
+    if (bucket->head[bucket->cur] != NO_INDEX) {
+      break;
+    }
+    ++bucket->cur;
+  }
+  return bucket->nodes[bucket->head[bucket->cur]].ind;
+}
+
+void bucket_pop(bucket_s *bucket) {
+  int ind = bucket_front(bucket);
+  int pos = bucket->head[bucket->cur];
+
+  unlink_node(bucket, pos);
+#if SJS_DEBUG
+  bucket->setpos(bucket->context, ind, NO_INDEX);
+#else
+  (void)ind;
+#endif
+
+  bucket->nodes[pos].ind = NO_INDEX;
+  bucket->nodes[pos].next = bucket->free;
+  bucket->free = pos;
+
+  // Once the queue is empty, close the window so that elements are
+  // put into the overflow list until the next call to `bucket_front`,
+  // which will then open a new window starting at the smallest key.
+  if (--bucket->size == 0) {
+    bucket->cur = NUM_BUCKETS;
+  }
+}
+
+int bucket_size(bucket_s const *bucket) {
+  return bucket->size;
+}
+
+dbl bucket_get_width(bucket_s const *bucket) {
+  return bucket->width;
+}
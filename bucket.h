@@ -0,0 +1,28 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "def.h"
+#include "heap.h"
+
+typedef struct bucket bucket_s;
+
+void bucket_alloc(bucket_s **bucket);
+void bucket_dealloc(bucket_s **bucket);
+void bucket_init(bucket_s *bucket, int capacity, dbl width, value_f value,
+                 setpos_f setpos, void *context);
+void bucket_deinit(bucket_s *bucket);
+void bucket_insert(bucket_s *bucket, int ind);
+void bucket_insert_with_key(bucket_s *bucket, int ind, dbl key);
+void bucket_swim(bucket_s *bucket, int pos);
+void bucket_update_key(bucket_s *bucket, int pos, dbl key);
+int bucket_front(bucket_s *bucket);
+void bucket_pop(bucket_s *bucket);
+int bucket_size(bucket_s const *bucket);
+dbl bucket_get_width(bucket_s const *bucket);
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,7 +10,66 @@ extern "C" {
 
 #define ROW_MAJOR_ORDERING 0
 #define COLUMN_MAJOR_ORDERING 1
+#define TILED_ORDERING 2
+#ifndef ORDERING
 #define ORDERING ROW_MAJOR_ORDERING
+#endif
+
+/**
+ * The tiles used by `TILED_ORDERING` are TILE_SIZE x TILE_SIZE
+ * blocks of nodes, where TILE_SIZE = 2^LOG2_TILE_SIZE. This needs to
+ * be at least 8 (see `eik.c`).
+ */
+#ifndef LOG2_TILE_SIZE
+#define LOG2_TILE_SIZE 4
+#endif
+#define TILE_SIZE (1 << LOG2_TILE_SIZE)
+
+/**
+ * How `eik_s` stores the jets at the grid nodes: either as an array
+ * of `jet_s` (AOS_JET_STORAGE), or as separate arrays of `f`, `fx`,
+ * `fy`, and `fxy` values (SOA_JET_STORAGE).
+ */
+#define AOS_JET_STORAGE 0
+#define SOA_JET_STORAGE 1
+#ifndef JET_STORAGE
+#define JET_STORAGE AOS_JET_STORAGE
+#endif
+
+/**
+ * How `eik_s` stores the bicubic interpolants on the cells: either
+ * one for every cell in the grid (DENSE_CELL_STORAGE), or only for
+ * the cells in the narrow band behind the front which triangle
+ * updates can still read (BAND_CELL_STORAGE). With the latter, other
+ * cells are rebuilt from the jets at their vertices when queried.
+ */
+#define DENSE_CELL_STORAGE 0
+#define BAND_CELL_STORAGE 1
+#ifndef CELL_STORAGE
+#define CELL_STORAGE DENSE_CELL_STORAGE
+#endif
+
+/**
+ * How `bicubic_s` represents a bicubic: either by its 4x4 matrix of
+ * monomial coefficients (COEF_BICUBIC_STORAGE), or by the values of
+ * f, fx, fy, and fxy at its vertices (VERT_BICUBIC_STORAGE), which
+ * are used directly with the cubic Hermite basis. The latter makes
+ * `bicubic_set_data` and the `bicubic_get_*_on_edge` functions
+ * (which are called for each triangle update) much cheaper.
+ */
+#define COEF_BICUBIC_STORAGE 0
+#define VERT_BICUBIC_STORAGE 1
+#ifndef BICUBIC_STORAGE
+#define BICUBIC_STORAGE COEF_BICUBIC_STORAGE
+#endif
+
+/**
+ * The default number of children of each node of `heap_s`. This can
+ * also be changed at runtime using `heap_set_arity`.
+ */
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4
+#endif
 
 #define EPS 1e-13
 #define NO_INDEX -1
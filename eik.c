@@ -2,6 +2,7 @@
 
 #include <assert.h>
 #include <math.h>
+#include <omp.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -12,6 +13,7 @@
 #include "hybrid.h"
 #include "index.h"
 #include "jet.h"
+#include "newton.h"
 
 #define NUM_CELL_VERTS 4
 #define NUM_CELL_NB_VERTS 9
@@ -19,32 +21,126 @@
 #define NUM_NB_CELLS 4
 #define NUM_NEARBY_CELLS 16
 
+/**
+ * The grid is padded with a margin of `MARGIN` nodes on each side,
+ * which are permanently BOUNDARY nodes. Since no stencil used below
+ * reaches more than two nodes (or cells) away from a node in the
+ * domain, every neighboring node or cell can be found by adding one
+ * of the offsets in `nb_dl`, `tri_dlc`, `nearby_dlc`, etc., without
+ * checking whether it's inbounds first.
+ */
+#define MARGIN 2
+
+/**
+ * With `TILED_ORDERING`, the offset from a node to one of its
+ * neighbors depends on whether the neighbor is in the same tile. But
+ * since the tiled linear index of (i, j) is a function of i plus a
+ * function of j, the offset only depends on where the node is in its
+ * tile, and only on whether it's within two nodes of the edge of the
+ * tile along each axis. So, we sort the nodes into 5 x 5 classes and
+ * store a set of offsets for each class (see `get_class`).
+ */
+#if ORDERING == TILED_ORDERING
+#define NUM_CLASSES 25
+#else
+#define NUM_CLASSES 1
+#endif
+
+/**
+ * Use `JET(eik, l, x)` to access member `x` (`f`, `fx`, `fy`, or
+ * `fxy`) of the jet at node `l`, regardless of `JET_STORAGE`.
+ */
+#if JET_STORAGE == SOA_JET_STORAGE
+#define JET(eik, l, x) ((eik)->jets.x[l])
+#else
+#define JET(eik, l, x) ((eik)->jets[l].x)
+#endif
+
+/**
+ * With `BAND_CELL_STORAGE`, the bicubics are stored in a pool made up
+ * of chunks of CELL_CHUNK_SIZE bicubics. Chunks are never moved once
+ * they're allocated, so the pool can grow without invalidating
+ * pointers into it.
+ */
+#if CELL_STORAGE == BAND_CELL_STORAGE
+#define LOG2_CELL_CHUNK_SIZE 10
+#define CELL_CHUNK_SIZE (1 << LOG2_CELL_CHUNK_SIZE)
+#endif
+
+/**
+ * The minimizer and inverse Hessian that each triangle update of a
+ * TRIAL node converged to last, which later updates of the node from
+ * the same triangle start from (see `tri`). Entry `ic0` is only
+ * filled in if bit `ic0` of `mask` is set.
+ */
+typedef struct warm_start {
+  dvec2 x[NUM_NB];
+  dmat22 H[NUM_NB];
+  unsigned char mask;
+} warm_start_s;
+
+/**
+ * Only TRIAL nodes have a `warm_start_s`, so they're kept in a pool of
+ * chunks of WARM_START_CHUNK_SIZE, like the cells with
+ * `BAND_CELL_STORAGE`.
+ */
+#define LOG2_WARM_START_CHUNK_SIZE 8
+#define WARM_START_CHUNK_SIZE (1 << LOG2_WARM_START_CHUNK_SIZE)
+
 /**
  * TODO: add a few words about what `eik` is and how it works
  *
  * TODO: add a few comments about how indexing works
  *
- * - row-major ordering is used
+ * - the ordering is selected with ORDERING (see def.h)
  * - l vs lc index spaces
+ * - `l` and `lc` index into the padded grid (see `MARGIN`), whose
+ *   shape is `padded_shape`; `shape` is the shape of the domain
  * - cell verts are in column major order
  */
 struct eik {
   field2_s const *slow;
-  ivec2 shape;
+  ivec2 shape, padded_shape;
   dvec2 xymin;
   dbl h;
   int nnodes, ncells;
-  int nb_dl[NUM_NB + 1];
-  int cell_nb_verts_dl[NUM_CELL_NB_VERTS];
-  int vert_dl[NUM_CELL_VERTS];
-  int tri_dlc[NUM_NB];
-  int nb_dlc[NUM_NB_CELLS];
-  int nearby_dlc[NUM_NEARBY_CELLS];
+  int nb_dl[NUM_CLASSES][NUM_NB + 1];
+  int cell_nb_verts_dl[NUM_CLASSES][NUM_CELL_NB_VERTS];
+  int vert_dl[NUM_CLASSES][NUM_CELL_VERTS];
+  int tri_dlc[NUM_CLASSES][NUM_NB];
+  int nb_dlc[NUM_CLASSES][NUM_NB_CELLS];
+  int nearby_dlc[NUM_CLASSES][NUM_NEARBY_CELLS];
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  int cell_user_dl[NUM_CLASSES][NUM_NB];
+  int *cell_slots; // slot of each cell in the pool, or NO_INDEX
+  bicubic_s **cell_chunks;
+  int num_cell_slots; // number of slots allocated so far
+  int *free_cell_slots, num_free_cell_slots, free_cell_slots_capacity;
+#else
   bicubic_s *bicubics;
+#endif
+#if JET_STORAGE == SOA_JET_STORAGE
+  jet_ptrs_s jets;
+#else
   jet_s *jets;
+#endif
   state_e *states;
   int *positions;
+  int *touched, num_touched; // nodes which have left FAR (see `touch`)
   heap_s *heap;
+  int *warm_start_slots; // slot of each node in the pool, or NO_INDEX
+  warm_start_s **warm_start_chunks;
+  int num_warm_start_slots; // number of slots allocated so far
+  int *free_warm_start_slots, num_free_warm_start_slots,
+    free_warm_start_slots_capacity;
+  bool use_newton;
+  bool use_warm_start;
+  dbl s_min; // lower bound on the slowness (see `eik_set_s_min`)
+  bool parallel_updates;
+  bool sweeping; // set while `eik_solve_sweep` is running
+  bool const *fixed; // initially VALID nodes while sweeping (see `update`)
+  bool discard_failed_updates; // see `tri`
+  eik_stats_s stats;
 };
 
 /**
@@ -188,13 +284,57 @@ static bool nearby_cell_is_cell_nb[NUM_NEARBY_CELLS] = {
   false, false, false, false
 };
 
-static void set_nb_dl(eik_s *eik) {
+/**
+ * Get the offset class of the node with index `l`. All nodes in the
+ * same class use the same offsets to find their neighbors.
+ */
+static int get_class(int l) {
+#if ORDERING == TILED_ORDERING
+  static int const mask = TILE_SIZE - 1;
+  int i = (l >> LOG2_TILE_SIZE) & mask, j = l & mask;
+  int ci = i < 2 ? i : i < TILE_SIZE - 2 ? 2 : i - TILE_SIZE + 5;
+  int cj = j < 2 ? j : j < TILE_SIZE - 2 ? 2 : j - TILE_SIZE + 5;
+  return 5*ci + cj;
+#else
+  (void)l;
+  return 0;
+#endif
+}
+
+/**
+ * Get the index of a node (in the padded grid) in class `c`. The
+ * offsets for class `c` are computed relative to this node.
+ */
+static ivec2 get_class_ind(int c) {
+#if ORDERING == TILED_ORDERING
+  static int const pos[5] = {0, 1, 2, TILE_SIZE - 2, TILE_SIZE - 1};
+  ivec2 ind = {.i = TILE_SIZE + pos[c/5], .j = TILE_SIZE + pos[c % 5]};
+#else
+  (void)c;
+  ivec2 ind = {.i = 0, .j = 0};
+#endif
+  return ind;
+}
+
+static int get_dl(eik_s const *eik, int c, ivec2 offset) {
+  ivec2 ind = get_class_ind(c);
+  ivec2 ind_nb = {.i = ind.i + offset.i, .j = ind.j + offset.j};
+  return ind2l(eik->padded_shape, ind_nb) - ind2l(eik->padded_shape, ind);
+}
+
+static int get_dlc(eik_s const *eik, int c, ivec2 offset) {
+  ivec2 ind = get_class_ind(c);
+  ivec2 ind_nb = {.i = ind.i + offset.i, .j = ind.j + offset.j};
+  return ind2lc(eik->padded_shape, ind_nb) - ind2lc(eik->padded_shape, ind);
+}
+
+static void set_nb_dl(eik_s *eik, int c) {
   for (int i = 0; i < NUM_NB + 1; ++i) {
-    eik->nb_dl[i] = ind2l(eik->shape, offsets[i]);
+    eik->nb_dl[c][i] = get_dl(eik, c, offsets[i]);
   }
 }
 
-static void set_cell_nb_verts_dl(eik_s *eik) {
+static void set_cell_nb_verts_dl(eik_s *eik, int c) {
   static ivec2 cell_nb_verts_offsets[NUM_CELL_NB_VERTS] = {
     {.i = -1, .j = -1},
     {.i = -1, .j =  0},
@@ -207,61 +347,169 @@ static void set_cell_nb_verts_dl(eik_s *eik) {
     {.i =  1, .j =  1}
   };
   for (int i = 0; i < NUM_CELL_NB_VERTS; ++i) {
-    eik->cell_nb_verts_dl[i] = ind2l(eik->shape, cell_nb_verts_offsets[i]);
+    eik->cell_nb_verts_dl[c][i] = get_dl(eik, c, cell_nb_verts_offsets[i]);
   }
 }
 
-static void set_vert_dl(eik_s *eik) {
+static void set_vert_dl(eik_s *eik, int c) {
   for (int i = 0; i < NUM_CELL_VERTS; ++i) {
-    eik->vert_dl[i] = ind2l(eik->shape, cell_vert_offsets[i]);
+    eik->vert_dl[c][i] = get_dl(eik, c, cell_vert_offsets[i]);
   }
 }
 
-static void set_tri_dlc(eik_s *eik) {
+static void set_tri_dlc(eik_s *eik, int c) {
   for (int i = 0; i < NUM_NB; ++i) {
-    eik->tri_dlc[i] = ind2lc(eik->shape, tri_cell_offsets[i]);
+    eik->tri_dlc[c][i] = get_dlc(eik, c, tri_cell_offsets[i]);
   }
 }
 
-static void set_nb_dlc(eik_s *eik) {
+static void set_nb_dlc(eik_s *eik, int c) {
   for (int i = 0; i < NUM_CELL_VERTS; ++i) {
-    eik->nb_dlc[i] = ind2lc(eik->shape, nb_cell_offsets[i]);
+    eik->nb_dlc[c][i] = get_dlc(eik, c, nb_cell_offsets[i]);
   }
 }
 
-static void set_nearby_dlc(eik_s *eik) {
+static void set_nearby_dlc(eik_s *eik, int c) {
   for (int i = 0; i < NUM_NEARBY_CELLS; ++i) {
-    eik->nearby_dlc[i] = ind2lc(eik->shape, nearby_cell_offsets[i]);
+    eik->nearby_dlc[c][i] = get_dlc(eik, c, nearby_cell_offsets[i]);
+  }
+}
+
+#if CELL_STORAGE == BAND_CELL_STORAGE
+/**
+ * Set the offsets from the upper-left vertex of a cell to each of
+ * the nodes whose triangle updates read that cell. These are just
+ * the `tri_cell_offsets`, reversed.
+ */
+static void set_cell_user_dl(eik_s *eik, int c) {
+  for (int i = 0; i < NUM_NB; ++i) {
+    ivec2 offset = {-tri_cell_offsets[i].i, -tri_cell_offsets[i].j};
+    eik->cell_user_dl[c][i] = get_dl(eik, c, offset);
   }
 }
+#endif
+
+/**
+ * Map an index into the domain to a linear index into the padded
+ * grid.
+ */
+static int get_l(eik_s const *eik, ivec2 ind) {
+  ivec2 ind_padded = {.i = ind.i + MARGIN, .j = ind.j + MARGIN};
+  return ind2l(eik->padded_shape, ind_padded);
+}
+
+static int get_lc(eik_s const *eik, ivec2 indc) {
+  ivec2 indc_padded = {.i = indc.i + MARGIN, .j = indc.j + MARGIN};
+  return indc2lc(eik->padded_shape, indc_padded);
+}
 
 static dvec2 get_xy(eik_s *eik, int l) {
-  ivec2 ind = l2ind(eik->shape, l);
+  ivec2 ind = l2ind(eik->padded_shape, l);
   dvec2 xy = {
-    .x = eik->h*ind.i + eik->xymin.x,
-    .y = eik->h*ind.j + eik->xymin.y
+    .x = eik->h*(ind.i - MARGIN) + eik->xymin.x,
+    .y = eik->h*(ind.j - MARGIN) + eik->xymin.y
   };
   return xy;
 }
 
+static jet_s get_jet(eik_s const *eik, int l) {
+  jet_s jet = {
+    .f = JET(eik, l, f),
+    .fx = JET(eik, l, fx),
+    .fy = JET(eik, l, fy),
+    .fxy = JET(eik, l, fxy)
+  };
+  return jet;
+}
+
+static void set_jet(eik_s *eik, int l, jet_s jet) {
+  JET(eik, l, f) = jet.f;
+  JET(eik, l, fx) = jet.fx;
+  JET(eik, l, fy) = jet.fy;
+  JET(eik, l, fxy) = jet.fxy;
+}
+
+/**
+ * Record that the FAR node `l` is about to change state, so that
+ * `eik_reset` knows to reset it. Every node which leaves FAR has to
+ * be passed to this first: since nodes never go back to being FAR
+ * (other than when they're reset), this is also every node whose
+ * jet has changed, and every cell which has been built has one of
+ * these nodes as a vertex.
+ */
+static void touch(eik_s *eik, int l) {
+  assert(eik->states[l] == FAR);
+  int k;
+#pragma omp atomic capture
+  k = eik->num_touched++;
+  eik->touched[k] = l;
+}
+
 dbl S4_th(dbl th, void *data) {
   S4_context *context = (S4_context *)data;
   S4_compute(th, context);
   return context->S4_th;
 }
 
-static void line(eik_s *eik, int l, int l0) {
-  jet_s const *J0 = &eik->jets[l0];
-  dbl T0 = J0->f;
-  dbl Tx0 = J0->fx;
-  dbl Ty0 = J0->fy;
+/**
+ * Like `S4_th`, but for `newton`.
+ */
+static dbl S4_th_newton(dbl th, dbl *S4_th_th, void *data) {
+  S4_context *context = (S4_context *)data;
+  if (S4_th_th == NULL) {
+    S4_compute(th, context);
+  } else {
+    S4_compute_hess(th, context);
+    *S4_th_th = context->S4_th_th;
+  }
+  return context->S4_th;
+}
+
+/**
+ * Check whether an update whose value is at least `T_lb` can't
+ * improve on `T_best` (see `line` and `tri`). The lower bounds can be
+ * tight (e.g., for a line update along a straight characteristic
+ * when the slowness is constant), so leave room for roundoff.
+ */
+static bool cant_improve(dbl T_lb, dbl T_best) {
+  return T_lb > T_best + EPS*fabs(T_best);
+}
+
+/**
+ * Do a line update from `l0` of the node at `xy`, where the slowness
+ * is `s`. The new value and the angle of the characteristic at `xy`
+ * are returned in `T` and `th`.
+ *
+ * The new value is T0 + L*S4, where L is the distance from `xy0` to
+ * `xy`, and S4 averages the slowness at `xy`, at `xy0`, and at a
+ * midpoint weighted by a factor which is at least one (see
+ * eik_S4.c). So, it's at least T0 + L*(s + 5*s_min)/6, where `s_min`
+ * is the lower bound set by `eik_set_s_min`. If this is no smaller
+ * than `T_best`, the update can't improve on it, so this returns
+ * false without doing it (see `cant_improve`).
+ */
+static bool line(eik_s *eik, dvec2 xy, dbl s, int l0, dbl T_best, dbl *T,
+                 dbl *th) {
+  dbl T0 = JET(eik, l0, f);
+  dbl Tx0 = JET(eik, l0, fx);
+  dbl Ty0 = JET(eik, l0, fy);
 
-  dvec2 xy = get_xy(eik, l);
   dvec2 xy0 = get_xy(eik, l0);
 
+  dbl L = dvec2_dist(xy, xy0);
+  if (cant_improve(T0 + L*(s + 5*eik->s_min)/6, T_best)) {
+    // `eik_solve_fim` does updates from several threads at once
+#pragma omp atomic
+    ++eik->stats.num_pruned_line_updates;
+    return false;
+  }
+
+#pragma omp atomic
+  ++eik->stats.num_line_updates;
+
   S4_context context;
   context.slow = eik->slow;
-  context.s = field2_f(eik->slow, xy);
+  context.s = s;
   context.s0 = field2_f(eik->slow, xy0);
   context.lp = dvec2_sub(xy, xy0);
   context.L = dvec2_norm(context.lp);
@@ -270,24 +518,21 @@ static void line(eik_s *eik, int l, int l0) {
   context.t0 = (dvec2) {.x = Tx0, .y = Ty0};
   dvec2_normalize(&context.t0);
 
-  dbl th = atan2(context.lp.y, context.lp.x);
+  *th = atan2(context.lp.y, context.lp.x);
   {
-    dbl th_min = th - PI_OVER_FOUR;
-    dbl th_max = th + PI_OVER_FOUR;
-    th = hybrid(S4_th, th_min, th_max, (void *)&context);
+    dbl th_min = *th - PI_OVER_FOUR;
+    dbl th_max = *th + PI_OVER_FOUR;
+    *th = field2_has_hess(eik->slow) ?
+      newton(S4_th_newton, th_min, th_max, NAN, (void *)&context) :
+      hybrid(S4_th, th_min, th_max, (void *)&context);
   }
 
-  dbl T = T0 + context.L*context.S4;
+  *T = T0 + context.L*context.S4;
 
   // Check causality
-  assert(T > T0);
+  assert(*T > T0);
 
-  jet_s *J = &eik->jets[l];
-  if (T < J->f) {
-    J->f = T;
-    J->fx = context.s*cos(th);
-    J->fy = context.s*sin(th);
-  }
+  return true;
 }
 
 dbl F3_eta(dbl eta, void *data) {
@@ -297,59 +542,371 @@ dbl F3_eta(dbl eta, void *data) {
 }
 
 /**
+ * Like `F3_eta`, but for `newton`.
+ */
+static dbl F3_eta_newton(dbl eta, dbl *F3_eta_eta, void *data) {
+  F3_context *context = (F3_context *)data;
+  if (F3_eta_eta == NULL) {
+    F3_compute(eta, context);
+  } else {
+    F3_compute_hess(eta, context);
+    *F3_eta_eta = context->F3_eta_eta;
+  }
+  return context->F3_eta;
+}
+
+/**
+ * TODO: we should describe precisely what "valid" means for a
+ * cell. Right now or definition is just "all of its incident
+ * vertices are VALID". If all of the incident vertices are VALID,
+ * then T, Tx, and Ty should all be finite for each incident vertex,
+ * which is enough to bilinearly interpolate Txy values. Cells which
+ * touch the margin are never valid, since the margin nodes are
+ * BOUNDARY nodes.
+ */
+static bool can_build_cell(eik_s const *eik, int lc) {
+  // TODO: do this using SIMD gathers
+  int l = lc2l(eik->padded_shape, lc);
+  int const *vert_dl = eik->vert_dl[get_class(l)];
+  for (int i = 0; i < NUM_CELL_VERTS; ++i) {
+    /**
+     * TODO: we don't want to build cells that only have trial values,
+     * I don't think...
+     */
+    if (eik->states[l + vert_dl[i]] != VALID) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Use the jets at the vertices of the cell at index `lc` to assemble
+ * the data matrix for its bicubic interpolant, and store the result
+ * in `bicubic`.
+ */
+static void compute_bicubic(eik_s const *eik, int lc, bicubic_s *bicubic) {
+  /* Get linear indices of cell vertices */
+  int l[4];
+  int l0 = lc2l(eik->padded_shape, lc);
+  int const *vert_dl = eik->vert_dl[get_class(l0)];
+  for (int i = 0; i < NUM_CELL_VERTS; ++i) {
+    l[i] = l0 + vert_dl[i];
+  }
+
+  /* Get jet at each cell vertex */
+  jet_s J[4];
+  for (int i = 0; i < NUM_CELL_VERTS; ++i) {
+    J[i] = get_jet(eik, l[i]);
+  }
+
+  /* Precompute scaling factors for partial derivatives */
+  dbl h = eik->h, h_sq = h*h;
+
+  /* Compute cell data from jets and scaling factors */
+  dmat44 data;
+  data.data[0][0] = J[0].f;
+  data.data[1][0] = J[1].f;
+  data.data[0][1] = J[2].f;
+  data.data[1][1] = J[3].f;
+  data.data[2][0] = h*J[0].fx;
+  data.data[3][0] = h*J[1].fx;
+  data.data[2][1] = h*J[2].fx;
+  data.data[3][1] = h*J[3].fx;
+  data.data[0][2] = h*J[0].fy;
+  data.data[1][2] = h*J[1].fy;
+  data.data[0][3] = h*J[2].fy;
+  data.data[1][3] = h*J[3].fy;
+  data.data[2][2] = h_sq*J[0].fxy;
+  data.data[3][2] = h_sq*J[1].fxy;
+  data.data[2][3] = h_sq*J[2].fxy;
+  data.data[3][3] = h_sq*J[3].fxy;
+
+  /* Set cell data */
+  bicubic_set_data(bicubic, data);
+}
+
+
+#if CELL_STORAGE == BAND_CELL_STORAGE
+/**
+ * Check whether a triangle update might still read the cell at index
+ * `lc`, i.e. whether one of the nodes which use it in `tri` hasn't
+ * been accepted yet. Only these cells are stored.
+ */
+static bool cell_needed(eik_s const *eik, int lc) {
+  int l = lc2l(eik->padded_shape, lc);
+  int const *cell_user_dl = eik->cell_user_dl[get_class(l)];
+  for (int i = 0; i < NUM_NB; ++i) {
+    state_e state = eik->states[l + cell_user_dl[i]];
+    if (state == FAR || state == TRIAL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bicubic_s *get_cell_slot(eik_s const *eik, int slot) {
+  bicubic_s *chunk = eik->cell_chunks[slot >> LOG2_CELL_CHUNK_SIZE];
+  return &chunk[slot & (CELL_CHUNK_SIZE - 1)];
+}
+#endif
+
+/**
+ * Get a pointer to the storage for the cell at index `lc`, making
+ * room for it first if necessary.
+ */
+static bicubic_s *alloc_cell(eik_s *eik, int lc) {
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  if (eik->cell_slots[lc] == NO_INDEX) {
+    int slot;
+    // `eik_solve_sweep` builds cells from several threads at once
+#pragma omp critical(cell_pool)
+    {
+      if (eik->num_free_cell_slots > 0) {
+        slot = eik->free_cell_slots[--eik->num_free_cell_slots];
+      } else {
+        slot = eik->num_cell_slots++;
+        if ((slot & (CELL_CHUNK_SIZE - 1)) == 0) {
+          bicubic_s *chunk = malloc(CELL_CHUNK_SIZE*sizeof(bicubic_s));
+          assert(chunk != NULL);
+          eik->cell_chunks[slot >> LOG2_CELL_CHUNK_SIZE] = chunk;
+        }
+      }
+    }
+    eik->cell_slots[lc] = slot;
+  }
+  return get_cell_slot(eik, eik->cell_slots[lc]);
+#else
+  return &eik->bicubics[lc];
+#endif
+}
+
+/**
+ * Throw away the cell at index `lc`, if it's been built.
+ */
+static void free_cell(eik_s *eik, int lc) {
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  int slot = eik->cell_slots[lc];
+  if (slot == NO_INDEX) {
+    return;
+  }
+  eik->cell_slots[lc] = NO_INDEX;
+#pragma omp critical(cell_pool)
+  {
+    if (eik->num_free_cell_slots == eik->free_cell_slots_capacity) {
+      eik->free_cell_slots_capacity = eik->free_cell_slots_capacity > 0 ?
+        2*eik->free_cell_slots_capacity : CELL_CHUNK_SIZE;
+      eik->free_cell_slots = realloc(
+        eik->free_cell_slots, eik->free_cell_slots_capacity*sizeof(int));
+      assert(eik->free_cell_slots != NULL);
+    }
+    eik->free_cell_slots[eik->num_free_cell_slots++] = slot;
+  }
+#else
+  bicubic_invalidate(&eik->bicubics[lc]);
+#endif
+}
+
+/**
+ * Get the bicubic for the cell at index `lc`, which is invalid (see
+ * `bicubic_valid`) if the cell hasn't been built. With
+ * `BAND_CELL_STORAGE`, cells which aren't stored are rebuilt in
+ * `tmp` from the jets at their vertices, if they're all VALID.
+ */
+static bicubic_s const *get_cell(eik_s const *eik, int lc, bicubic_s *tmp) {
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  if (eik->cell_slots[lc] != NO_INDEX) {
+    return get_cell_slot(eik, eik->cell_slots[lc]);
+  }
+  if (can_build_cell(eik, lc)) {
+    compute_bicubic(eik, lc, tmp);
+  } else {
+    bicubic_invalidate(tmp);
+  }
+  return tmp;
+#else
+  (void)tmp;
+  return &eik->bicubics[lc];
+#endif
+}
+
+static warm_start_s *get_warm_start_slot(eik_s const *eik, int slot) {
+  warm_start_s *chunk = eik->warm_start_chunks[
+    slot >> LOG2_WARM_START_CHUNK_SIZE];
+  return &chunk[slot & (WARM_START_CHUNK_SIZE - 1)];
+}
+
+/**
+ * Get the warm starts for the triangle updates of `l`, or NULL if
+ * there aren't any yet.
+ */
+static warm_start_s *get_warm_start(eik_s const *eik, int l) {
+  int slot = eik->warm_start_slots[l];
+  return slot == NO_INDEX ? NULL : get_warm_start_slot(eik, slot);
+}
+
+/**
+ * Get a pointer to the warm starts for `l`, making room for them
+ * first if necessary. New warm starts are empty.
+ */
+static warm_start_s *alloc_warm_start(eik_s *eik, int l) {
+  if (eik->warm_start_slots[l] == NO_INDEX) {
+    int slot;
+    // Neighboring nodes may be updated by several threads at once
+    // (see `eik_set_parallel_updates`)
+#pragma omp critical(warm_start_pool)
+    {
+      if (eik->num_free_warm_start_slots > 0) {
+        slot = eik->free_warm_start_slots[--eik->num_free_warm_start_slots];
+      } else {
+        slot = eik->num_warm_start_slots++;
+        if ((slot & (WARM_START_CHUNK_SIZE - 1)) == 0) {
+          warm_start_s *chunk = malloc(
+            WARM_START_CHUNK_SIZE*sizeof(warm_start_s));
+          assert(chunk != NULL);
+          eik->warm_start_chunks[slot >> LOG2_WARM_START_CHUNK_SIZE] = chunk;
+        }
+      }
+    }
+    eik->warm_start_slots[l] = slot;
+    get_warm_start_slot(eik, slot)->mask = 0;
+  }
+  return get_warm_start_slot(eik, eik->warm_start_slots[l]);
+}
+
+/**
+ * Throw away the warm starts for `l`, if it has any. This should be
+ * called once `l` stops being TRIAL.
+ */
+static void free_warm_start(eik_s *eik, int l) {
+  int slot = eik->warm_start_slots[l];
+  if (slot == NO_INDEX) {
+    return;
+  }
+  eik->warm_start_slots[l] = NO_INDEX;
+#pragma omp critical(warm_start_pool)
+  {
+    if (eik->num_free_warm_start_slots ==
+        eik->free_warm_start_slots_capacity) {
+      eik->free_warm_start_slots_capacity =
+        eik->free_warm_start_slots_capacity > 0 ?
+        2*eik->free_warm_start_slots_capacity : WARM_START_CHUNK_SIZE;
+      eik->free_warm_start_slots = realloc(
+        eik->free_warm_start_slots,
+        eik->free_warm_start_slots_capacity*sizeof(int));
+      assert(eik->free_warm_start_slots != NULL);
+    }
+    eik->free_warm_start_slots[eik->num_free_warm_start_slots++] = slot;
+  }
+}
+
+/**
+ * Get a lower bound on the value of a triangle update from `l0` and
+ * `l1` (see `tri`) of a node where the slowness is `s`.
+ *
+ * The update minimizes F4 = T + L*S over the edge from `l0` to `l1`
+ * (see eik_F4.c). Along this edge, T is the cubic Hermite
+ * interpolant of the jets at `l0` and `l1`. By the convex hull
+ * property of the Bernstein basis, T is at least the smallest of its
+ * four Bernstein coefficients, which we get directly from the
+ * jets. Since `l0` is next to `l` and the edge is perpendicular to
+ * the one from `l` to `l0`, L is at least `h`. And, like S4 in
+ * `line`, S is at least (s + 5*s_min)/6.
+ */
+static dbl tri_lower_bound(eik_s const *eik, dbl s, int l0, int l1,
+                           dvec2 xy0, dvec2 xy1) {
+  dvec2 dxy = dvec2_sub(xy1, xy0);
+  dbl T0 = JET(eik, l0, f);
+  dbl T1 = JET(eik, l1, f);
+  dbl T0_edge = JET(eik, l0, fx)*dxy.x + JET(eik, l0, fy)*dxy.y;
+  dbl T1_edge = JET(eik, l1, fx)*dxy.x + JET(eik, l1, fy)*dxy.y;
+  dbl T_min = fmin(fmin(T0, T1), fmin(T0 + T0_edge/3, T1 - T1_edge/3));
+  return T_min + eik->h*(s + 5*eik->s_min)/6;
+}
+
+/**
+ * Do a triangle update of `l` from `l0` and `l1`, where `xy` is the
+ * location of `l` and `s` is the slowness there. The new value and
+ * the angle of the characteristic at `l` are returned in `T` and
+ * `th`.
+ *
  * In this function, `ic0` is used as an index to select a nearby
  * bicubic interpolant which will be used to approximate `T`
  * locally.
  *
- * If the cell being indexed by ic0 is out of bounds, or if the cell
- * is invalid, this function does nothing.
+ * If the cell being indexed by ic0 is invalid, if the update can't
+ * improve on `T_best` (see `tri_lower_bound`), or if the update fails
+ * and `discard_failed_updates` is set (see below), this function
+ * returns false and does nothing, except that `*failed` is set in
+ * the last case.
+ *
+ * Failed updates are discarded while sweeping, since the neighbors
+ * may be far from upwind, by `eik_solve_fim` (see there), and in the
+ * subdomains solved by `eik_solve_parallel`. The halo nodes near the
+ * edge of a subdomain are only updated from inside it, so their jets
+ * can be far off until the tiles which own them are solved, and the
+ * cells built from them can make triangle updates of other halo
+ * nodes fail.
  */
-static void tri(eik_s *eik, int l, int l0, int l1, int ic0) {
+static bool tri(eik_s *eik, int l, dvec2 xy, dbl s, int l0, int l1, int ic0,
+                dbl T_best, dbl *T_out, dbl *th_out, bool *failed) {
   assert(ic0 >= 0);
   assert(ic0 < NUM_NB);
 
-  int lc = l2lc(eik->shape, l) + eik->tri_dlc[ic0];
-  if (lc < 0 || eik->ncells <= lc) {
-    return;
+  int lc = l2lc(eik->padded_shape, l) + eik->tri_dlc[get_class(l)][ic0];
+  bicubic_s tmp;
+  bicubic_s const *bicubic = get_cell(eik, lc, &tmp);
+  if (!bicubic_valid(bicubic)) {
+    return false;
   }
 
-  bicubic_s *bicubic = &eik->bicubics[lc];
-  if (!bicubic_valid(bicubic)) {
-    return;
+  dvec2 xy0 = get_xy(eik, l0);
+  dvec2 xy1 = get_xy(eik, l1);
+
+  if (cant_improve(tri_lower_bound(eik, s, l0, l1, xy0, xy1), T_best)) {
+#pragma omp atomic
+    ++eik->stats.num_pruned_tri_updates;
+    return false;
   }
 
+#pragma omp atomic
+  ++eik->stats.num_tri_updates;
+
   /**
-   * Get cubic along edge of interest.
+   * Get cubics along edge of interest, oriented so that they run
+   * from `l0` to `l1`.
    */
-  bicubic_variable var = tri_bicubic_vars[ic0];
-  int edge = tri_edges[ic0];
-  cubic_s T_cubic = bicubic_get_f_on_edge(bicubic, var, edge);
-  cubic_s Tx_cubic = bicubic_get_fx_on_edge(bicubic, var, edge);
-  cubic_s Ty_cubic = bicubic_get_fy_on_edge(bicubic, var, edge);
-  if (should_reverse_cubic[ic0]) {
-    cubic_reverse_on_unit_interval(&T_cubic);
-    cubic_reverse_on_unit_interval(&Tx_cubic);
-    cubic_reverse_on_unit_interval(&Ty_cubic);
-  }
-
-  dvec2 xy = get_xy(eik, l);
-  dvec2 xy0 = get_xy(eik, l0);
-  dvec2 xy1 = get_xy(eik, l1);
+  cubic_s T_cubic, Tx_cubic, Ty_cubic;
+  bicubic_get_cubics_on_edge(
+    bicubic, tri_bicubic_vars[ic0], tri_edges[ic0], should_reverse_cubic[ic0],
+    &T_cubic, &Tx_cubic, &Ty_cubic);
 
   // TODO: try initializing from the mp0 minimizer since it's so cheap
   // to compute...
 
   /**
-   * Compute initial guess for eta and theta by minimizing F3.
+   * If this triangle update of `l` has converged before, start from
+   * where it converged to last time (see `eik_set_use_warm_start`):
+   * the cell has been rebuilt since then, but usually not by much.
    */
-  dbl eta, th;
-  {
+  bool use_warm_start = eik->use_warm_start && !eik->sweeping;
+  warm_start_s *warm_start = use_warm_start ? get_warm_start(eik, l) : NULL;
+  bool warm = warm_start != NULL && (warm_start->mask & (1 << ic0));
+
+  /**
+   * Otherwise, compute initial guess for eta and theta by minimizing
+   * F3.
+   */
+  dbl eta = NAN, th = NAN;
+  if (!warm) {
     F3_context context = {
-      .T_cubic = T_cubic, .xy = xy, .xy0 = xy0, .xy1 = xy1, .slow = eik->slow
+      .T_cubic = T_cubic, .xy = xy, .xy0 = xy0, .xy1 = xy1, .slow = eik->slow,
+      .s = s
     };
-    eta = hybrid(F3_eta, 0, 1, (void *)&context);
-  }
-  {
+    eta = field2_has_hess(eik->slow) ?
+      newton(F3_eta_newton, 0, 1, NAN, (void *)&context) :
+      hybrid(F3_eta, 0, 1, (void *)&context);
+
     dvec2 dxy = dvec2_sub(xy1, xy0);
     dvec2 xyeta = dvec2_add(xy0, dvec2_dbl_mul(dxy, eta));
     dvec2 lp = dvec2_sub(xy, xyeta);
@@ -363,7 +920,8 @@ static void tri(eik_s *eik, int l, int l0, int l1, int ic0) {
   // TODO: this is still a little rough and unfinished (hence the
   // "construction signs" delimiting this section). We want to remove
   // the print statements below and decide on a robust error-handling
-  // strategy so that `abort` is never called.
+  // strategy so that `abort` is never called. (For now, failed
+  // updates are only discarded when `discard_failed_updates` is set.)
 
   dbl T = NAN;
 
@@ -375,17 +933,40 @@ static void tri(eik_s *eik, int l, int l0, int l1, int ic0) {
       .xy = xy,
       .xy0 = xy0,
       .xy1 = xy1,
-      .slow = eik->slow
+      .slow = eik->slow,
+      .s = s
     };
 
-    dvec2 xk, gk;
+    dvec2 xk, gk, xprev;
     dmat22 Hk;
-    F4_bfgs_init(eta, th, &xk, &gk, &Hk, &context);
-    dbl Tprev = context.F4;
+    if (warm) {
+      xk = warm_start->x[ic0];
+      F4_compute(xk.x, xk.y, &context);
+      gk = F4_get_grad(&context);
+      Hk = warm_start->H[ic0];
+    } else {
+      F4_bfgs_init(eta, th, &xk, &gk, &Hk, &context);
+    }
+
+    // If we start at a minimizer (e.g., if the jets are exact, as
+    // they are near a point source with a constant slowness), the
+    // gradient vanishes and `step` returns false right away, since
+    // there's no descent direction. So, start with T at `xk`.
+    T = context.F4;
+    dbl Tprev = T;
+    xprev = xk;
+
+    bool (*step)(dvec2, dvec2, dmat22, dvec2 *, dvec2 *, dmat22 *,
+                 F4_context *) =
+      eik->use_newton ? F4_newton_step : F4_bfgs_step;
 
     int iter = 0;
-    while (F4_bfgs_step(xk, gk, Hk, &xk, &gk, &Hk, &context)) {
+    while (step(xk, gk, Hk, &xk, &gk, &Hk, &context)) {
       if (xk.x < 0 || xk.x > 1) {
+        if (eik->discard_failed_updates) {
+          *failed = true;
+          return false;
+        }
         printf("out of bounds: eta = %g\n", xk.x);
         abort();
       }
@@ -403,15 +984,57 @@ static void tri(eik_s *eik, int l, int l0, int l1, int ic0) {
       }
 
       if (iter >= 20) {
+        // The iterates can crawl along a flat valley toward an edge of
+        // the base (for `scratch 2049 -r`, T changed by about 1e-11 per
+        // step), where F4 is only accurate to about that anyway. Keep
+        // T if it's that close to converged.
+        if (fabs(T - Tprev) <= sqrt(EPS)*fabs(fmax(T, Tprev))) {
+          if (T > Tprev) {
+            T = Tprev;
+            xk = xprev;
+          }
+          break;
+        }
+        if (eik->discard_failed_updates) {
+          *failed = true;
+          return false;
+        }
         printf("exceeded number of iterations\n");
         abort();
       }
+      /**
+       * If T increased, the iteration has stalled (e.g., the step was
+       * too small to do a line search), so keep the previous iterate.
+       */
       if (T > Tprev) {
-        printf("no decrease in T: (%g > %g)\n", T, Tprev);
-        abort();
+        T = Tprev;
+        xk = xprev;
+        break;
       }
 
       Tprev = T;
+      xprev = xk;
+    }
+
+#pragma omp atomic
+    eik->stats.num_bfgs_iters += iter;
+    if (warm) {
+#pragma omp atomic
+      ++eik->stats.num_warm_starts;
+    }
+
+    // The DFP update can leave Hk indefinite (or NaN, if the change in
+    // the gradient is at the level of roundoff), and `step` can't
+    // start from that, so only keep positive definite ones.
+    if (use_warm_start) {
+      if (dmat22_det(&Hk) > 0 && dmat22_trace(&Hk) > 0) {
+        warm_start = alloc_warm_start(eik, l);
+        warm_start->x[ic0] = xk;
+        warm_start->H[ic0] = Hk;
+        warm_start->mask |= 1 << ic0;
+      } else if (warm_start != NULL) {
+        warm_start->mask &= ~(1 << ic0);
+      }
     }
 
     th = xk.y;
@@ -419,109 +1042,50 @@ static void tri(eik_s *eik, int l, int l0, int l1, int ic0) {
 
   //////////////////////////////////////////////////////////////////////////////
 
-  // Check causality
-  assert(T > eik->jets[l0].f);
-  assert(T > eik->jets[l1].f);
+  // Check causality. When sweeping or in a subdomain, `l0` and `l1`
+  // may not be upwind of `l` (yet), in which case the update is just
+  // discarded.
+  bool causal = T > JET(eik, l0, f) && T > JET(eik, l1, f);
+  if (eik->discard_failed_updates && !causal) {
+    *failed = true;
+    return false;
+  }
+  assert(causal);
 
+  *T_out = T;
+  *th_out = th;
+  return true;
+}
+
+static dvec4 interpolate_Txy_at_verts(eik_s *eik, int lc) {
   /**
-   * Commit new value if it's an improvement.
+   * TODO: this probably works, but we'll use the original thing just
+   * to be safe... Once we're computing good `fxy` values we can turn
+   * this back on
    */
-  jet_s *jet = &eik->jets[l];
-  if (T < jet->f) {
-    jet->f = T;
+  // dvec4 fx, fy;
+  // int l = lc2l(eik->padded_shape, lc);
+  // int const *vert_dl = eik->vert_dl[get_class(l)];
+  // for (int iv = 0, lv; iv < NUM_CELL_VERTS; ++iv) {
+  //   lv = l + vert_dl[iv];
+  //   fx.data[iv] = JET(eik, lv, fx);
+  //   fy.data[iv] = JET(eik, lv, fy);
+  // }
+  // return interpolate_fxy_at_verts(fx, fy, eik->h);
 
-    dbl s = field2_f(eik->slow, xy);
-    jet->fx = s*cos(th);
-    jet->fy = s*sin(th);
-  }
-}
+  /**
+   * ... we'll just use this for now since I have more confidence that
+   * it *does* work
+   */
 
-/**
- * Returns whether the linear index `l` corresponds to a valid index
- * into `eik`'s domain.
- */
-static bool inbounds(eik_s const *eik, ivec2 ind) {
-  ivec2 shape = eik->shape;
-  return 0 <= ind.i && ind.i < shape.i && 0 <= ind.j && ind.j < shape.j;
-}
+  dbl fx[NUM_CELL_VERTS], fy[NUM_CELL_VERTS];
 
-static bool can_build_cell(eik_s const *eik, int lc) {
-  // TODO: do this using SIMD gathers
+  int l0 = lc2l(eik->padded_shape, lc);
+  int const *vert_dl = eik->vert_dl[get_class(l0)];
   for (int i = 0, l; i < NUM_CELL_VERTS; ++i) {
-    l = lc2l(eik->shape, lc) + eik->vert_dl[i];
-    // TODO: this is probably wrong: need to double check what's in
-    // vert_dl to be sure---it's probably wrapping around... although
-    // this may not result in an actual bug?
-    if (!inbounds(eik, l2ind(eik->shape, l))) {
-      return false;
-    }
-    state_e state = eik->states[l];
-    /**
-     * TODO: we don't want to build cells that only have trial values,
-     * I don't think...
-     */
-    if (state != VALID) {
-      return false;
-    }
-  }
-  return true;
-}
-
-/**
- * TODO: we should describe precisely what "valid" means for a
- * cell. Right now or definition is just "the cell is inbounds and all
- * of its incident vertices are VALID". If all of the incident
- * vertices are VALID, then T, Tx, and Ty should all be finite for
- * each incident vertex, which is enough to bilinearly interpolate Txy
- * values.
- */
-static bool cell_is_valid(eik_s const *eik, ivec2 indc) {
-  ivec2 shape = eik->shape;
-  if (!(0 <= indc.i && indc.i < shape.i - 1 &&
-		0 <= indc.j && indc.j < shape.j - 1)) {
-    return false;
-  }
-  int l = indc2l(eik->shape, indc);
-  for (int iv = 0, lv; iv < NUM_CELL_VERTS; ++iv) {
-    ivec2 indv = ivec2_add(indc, cell_vert_offsets[iv]);
-    if (!(0 <= indv.i && indv.i < shape.i &&
-		  0 <= indv.j && indv.j < shape.j)) {
-      return false;
-    }
-    lv = l + eik->vert_dl[iv];
-    if (eik->states[lv] != VALID) {
-      return false;
-    }
-  }
-  return true;
-}
-
-static dvec4 interpolate_Txy_at_verts(eik_s *eik, int lc) {
-  /**
-   * TODO: this probably works, but we'll use the original thing just
-   * to be safe... Once we're computing good `fxy` values we can turn
-   * this back on
-   */
-  // dvec4 fx, fy;
-  // int l = lc2l(eik->shape, lc);
-  // for (int iv = 0, lv; iv < NUM_CELL_VERTS; ++iv) {
-  //   lv = l + eik->vert_dl[iv];
-  //   fx.data[iv] = eik->jets[lv].fx;
-  //   fy.data[iv] = eik->jets[lv].fy;
-  // }
-  // return interpolate_fxy_at_verts(fx, fy, eik->h);
-
-  /**
-   * ... we'll just use this for now since I have more confidence that
-   * it *does* work
-   */
-
-  dbl fx[NUM_CELL_VERTS], fy[NUM_CELL_VERTS];
-
-  for (int i = 0, l; i < NUM_CELL_VERTS; ++i) {
-    l = lc2l(eik->shape, lc) + eik->vert_dl[i];
-    fx[i] = eik->jets[l].fx;
-    fy[i] = eik->jets[l].fy;
+    l = l0 + vert_dl[i];
+    fx[i] = JET(eik, l, fx);
+    fy[i] = JET(eik, l, fy);
   }
 
   dbl fxy[NUM_CELL_VERTS] = {
@@ -550,110 +1114,102 @@ static dvec4 interpolate_Txy_at_verts(eik_s *eik, int lc) {
 
 static dvec4 get_cell_Txy_values(eik_s const *eik, int lc) {
   dvec4 Txy;
+  int l0 = lc2l(eik->padded_shape, lc);
+  int const *vert_dl = eik->vert_dl[get_class(l0)];
   for (int i = 0, l; i < NUM_CELL_VERTS; ++i) {
-    l = lc2l(eik->shape, lc) + eik->vert_dl[i];
-    Txy.data[i] = eik->jets[l].fxy;
+    l = l0 + vert_dl[i];
+    Txy.data[i] = JET(eik, l, fxy);
     assert(isfinite(Txy.data[i]));
   }
   return Txy;
 }
 
 /**
- * Build the cell at index `lc`. This uses the jets at the cells
- * vertices to assemble the data matrix for the bicubic
- * interpolant. This function doesn't make any assumptions about the
- * state of the nodes, so it's assumed that the caller has already
- * made sure this is a reasonable thing to try to do.
+ * Build the cell at index `lc`. This doesn't make any assumptions
+ * about the state of the nodes, so it's assumed that the caller has
+ * already made sure this is a reasonable thing to try to do.
  */
 static void build_cell(eik_s *eik, int lc) {
-  /* Get linear indices of cell vertices */
-  int l[4];
-  for (int i = 0; i < NUM_CELL_VERTS; ++i) {
-    l[i] = lc2l(eik->shape, lc) + eik->vert_dl[i];
-  }
-
-  /* Get jet at each cell vertex */
-  jet_s *J[4];
-  for (int i = 0; i < NUM_CELL_VERTS; ++i) {
-    J[i] = &eik->jets[l[i]];
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  if (!cell_needed(eik, lc)) {
+    free_cell(eik, lc);
+    return;
   }
+#endif
+  compute_bicubic(eik, lc, alloc_cell(eik, lc));
+}
 
-  /* Precompute scaling factors for partial derivatives */
-  dbl h = eik->h, h_sq = h*h;
+/**
+ * Update `l` from each of its VALID neighbors, committing the best of
+ * the triangle and line updates if it improves on `l`'s current
+ * value. Each update starts at `l`, so its location and the slowness
+ * there are computed once and shared by all of them. Returns false
+ * if any of the triangle updates failed and was discarded (see
+ * `tri`).
+ */
+/**
+ * Check whether `l0` and `l1` were both VALID initially while
+ * sweeping. `eik_solve` never updates a node from these alone, since
+ * it only updates the neighbors of the nodes it accepts: the initial
+ * jets of the TRIAL nodes next to them are used instead, and when
+ * sweeping, updates from them can undercut those jets.
+ */
+static bool is_fixed(eik_s const *eik, int l0, int l1) {
+  return eik->fixed != NULL && eik->fixed[l0] && eik->fixed[l1];
+}
 
-  /* Compute cell data from jets and scaling factors */
-  dmat44 data;
-  data.data[0][0] = J[0]->f;
-  data.data[1][0] = J[1]->f;
-  data.data[0][1] = J[2]->f;
-  data.data[1][1] = J[3]->f;
-  data.data[2][0] = h*J[0]->fx;
-  data.data[3][0] = h*J[1]->fx;
-  data.data[2][1] = h*J[2]->fx;
-  data.data[3][1] = h*J[3]->fx;
-  data.data[0][2] = h*J[0]->fy;
-  data.data[1][2] = h*J[1]->fy;
-  data.data[0][3] = h*J[2]->fy;
-  data.data[1][3] = h*J[3]->fy;
-  data.data[2][2] = h_sq*J[0]->fxy;
-  data.data[3][2] = h_sq*J[1]->fxy;
-  data.data[2][3] = h_sq*J[2]->fxy;
-  data.data[3][3] = h_sq*J[3]->fxy;
+static bool update(eik_s *eik, int l) {
+  int const *nb_dl = eik->nb_dl[get_class(l)];
 
-  /* Set cell data */
-  bicubic_set_data(&eik->bicubics[lc], data);
-}
+  dvec2 xy = get_xy(eik, l);
+  dbl s = field2_f(eik->slow, xy);
 
-static void update(eik_s *eik, int l) {
-  /**
-   * First, precompute whether each neighboring node is inbounds. We
-   * need to do this in the (i, j) index space to avoid wrapping
-   * errors.
-   */
-  bool inbounds_[9];
-  {
-    ivec2 ind = l2ind(eik->shape, l), ind0;
-    for (int i0 = 0; i0 < 9; ++i0) {
-      ind0 = ivec2_add(ind, offsets[i0]);
-      inbounds_[i0] = inbounds(eik, ind0);
-    }
-  }
+  dbl T_best = JET(eik, l, f), th_best = NAN, T, th;
+  bool failed = false;
 
   for (int i0 = 1, l0, l1, ic0; i0 < 8; i0 += 2) {
-    if (!inbounds_[i0]) {
-      continue;
-    }
-
-    l0 = l + eik->nb_dl[i0];
+    l0 = l + nb_dl[i0];
     if (eik->states[l0] != VALID) {
       continue;
     }
 
-    if (inbounds_[i0 - 1]) {
-      l1 = l + eik->nb_dl[i0 - 1];
-      if (eik->states[l1] == VALID) {
-        ic0 = i0 - 1;
-        tri(eik, l, l0, l1, ic0);
+    l1 = l + nb_dl[i0 - 1];
+    if (eik->states[l1] == VALID && !is_fixed(eik, l0, l1)) {
+      ic0 = i0 - 1;
+      if (tri(eik, l, xy, s, l0, l1, ic0, T_best, &T, &th, &failed) &&
+          T < T_best) {
+        T_best = T;
+        th_best = th;
       }
     }
 
-    if (inbounds_[i0 + 1]) {
-      l1 = l + eik->nb_dl[i0 + 1];
-      if (eik->states[l1] == VALID) {
-        ic0 = i0;
-        tri(eik, l, l0, l1, ic0);
+    l1 = l + nb_dl[i0 + 1];
+    if (eik->states[l1] == VALID && !is_fixed(eik, l0, l1)) {
+      ic0 = i0;
+      if (tri(eik, l, xy, s, l0, l1, ic0, T_best, &T, &th, &failed) &&
+          T < T_best) {
+        T_best = T;
+        th_best = th;
       }
     }
   }
 
   for (int i0 = 0, l0; i0 < 8; ++i0) {
-    if (inbounds_[i0]) {
-      l0 = l + eik->nb_dl[i0];
-      if (eik->states[l0] == VALID) {
-        line(eik, l, l0);
-      }
+    l0 = l + nb_dl[i0];
+    if (eik->states[l0] == VALID && !is_fixed(eik, l0, l0) &&
+        line(eik, xy, s, l0, T_best, &T, &th) && T < T_best) {
+      T_best = T;
+      th_best = th;
     }
   }
+
+  if (T_best < JET(eik, l, f)) {
+    JET(eik, l, f) = T_best;
+    JET(eik, l, fx) = s*cos(th_best);
+    JET(eik, l, fy) = s*sin(th_best);
+  }
+
+  return !failed;
 }
 
 static void adjust(eik_s *eik, int l0) {
@@ -661,14 +1217,14 @@ static void adjust(eik_s *eik, int l0) {
   assert(l0 >= 0);
   assert(l0 < eik->nnodes);
 
-  heap_swim(eik->heap, eik->positions[l0]);
+  heap_update_key(eik->heap, eik->positions[l0], JET(eik, l0, f));
 }
 
 static dbl value(void *vp, int l) {
   eik_s *eik = (eik_s *)vp;
   assert(l >= 0);
   assert(l < eik->nnodes);
-  dbl T = eik->jets[l].f;
+  dbl T = JET(eik, l, f);
   return T;
 }
 
@@ -688,25 +1244,70 @@ void eik_dealloc(eik_s **eik) {
 }
 
 // TODO: since the margins are BOUNDARY nodes, we actually don't need
-// to allocate an extra margin of cells, since they will never be
+// to allocate the cells in the margin, since they will never be
 // initialized (i.e., they will never have all of their vertex nodes
 // become VALID because of the margin...)
 void eik_init(eik_s *eik, field2_s const *slow, ivec2 shape, dvec2 xymin, dbl h) {
   eik->slow = slow;
   eik->shape = shape;
-  eik->ncells = (shape.i - 1)*(shape.j - 1);
-  eik->nnodes = shape.i*shape.j;
+  eik->padded_shape.i = shape.i + 2*MARGIN;
+  eik->padded_shape.j = shape.j + 2*MARGIN;
+#if ORDERING == TILED_ORDERING
+  // Round the padded grid up to a whole number of tiles. The extra
+  // nodes are BOUNDARY nodes, like the rest of the margin. Since
+  // cells are indexed by their upper-left vertex, there's one cell
+  // per node (the last row and column of cells are unused).
+  eik->padded_shape.i = (eik->padded_shape.i + TILE_SIZE - 1) & -TILE_SIZE;
+  eik->padded_shape.j = (eik->padded_shape.j + TILE_SIZE - 1) & -TILE_SIZE;
+  eik->ncells = eik->padded_shape.i*eik->padded_shape.j;
+#else
+  eik->ncells = (eik->padded_shape.i - 1)*(eik->padded_shape.j - 1);
+#endif
+  eik->nnodes = eik->padded_shape.i*eik->padded_shape.j;
   eik->xymin = xymin;
   eik->h = h;
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  eik->cell_slots = malloc(eik->ncells*sizeof(int));
+  eik->cell_chunks = calloc(
+    (eik->ncells + CELL_CHUNK_SIZE - 1)/CELL_CHUNK_SIZE, sizeof(bicubic_s *));
+#else
   eik->bicubics = malloc(eik->ncells*sizeof(bicubic_s));
+#endif
+#if JET_STORAGE == SOA_JET_STORAGE
+  eik->jets.f = malloc(eik->nnodes*sizeof(dbl));
+  eik->jets.fx = malloc(eik->nnodes*sizeof(dbl));
+  eik->jets.fy = malloc(eik->nnodes*sizeof(dbl));
+  eik->jets.fxy = malloc(eik->nnodes*sizeof(dbl));
+#else
   eik->jets = malloc(eik->nnodes*sizeof(jet_s));
+#endif
   eik->states = malloc(eik->nnodes*sizeof(state_e));
   eik->positions = malloc(eik->nnodes*sizeof(int));
-
+  eik->touched = malloc(eik->nnodes*sizeof(int));
+  eik->warm_start_slots = malloc(eik->nnodes*sizeof(int));
+  eik->warm_start_chunks = calloc(
+    (eik->nnodes + WARM_START_CHUNK_SIZE - 1)/WARM_START_CHUNK_SIZE,
+    sizeof(warm_start_s *));
+
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  assert(eik->cell_slots != NULL);
+  assert(eik->cell_chunks != NULL);
+#else
   assert(eik->bicubics != NULL);
+#endif
+#if JET_STORAGE == SOA_JET_STORAGE
+  assert(eik->jets.f != NULL);
+  assert(eik->jets.fx != NULL);
+  assert(eik->jets.fy != NULL);
+  assert(eik->jets.fxy != NULL);
+#else
   assert(eik->jets != NULL);
+#endif
   assert(eik->states != NULL);
   assert(eik->positions != NULL);
+  assert(eik->touched != NULL);
+  assert(eik->warm_start_slots != NULL);
+  assert(eik->warm_start_chunks != NULL);
 
 #if SJS_DEBUG
   for (int l = 0; l < eik->nnodes; ++l) {
@@ -714,46 +1315,128 @@ void eik_init(eik_s *eik, field2_s const *slow, ivec2 shape, dvec2 xymin, dbl h)
   }
 #endif
 
+  eik->use_newton = false;
+  eik->use_warm_start = true;
+  eik->s_min = 0;
+  eik->parallel_updates = false;
+  eik->sweeping = false;
+  eik->fixed = NULL;
+  eik->discard_failed_updates = false;
+  eik->num_touched = 0;
+  eik->stats = (eik_stats_s) {0};
+
   heap_alloc(&eik->heap);
 
   int capacity = (int) 3*sqrt(eik->shape.i*eik->shape.j);
   heap_init(eik->heap, capacity, value, setpos, (void *)eik);
 
-  set_nb_dl(eik);
-  set_cell_nb_verts_dl(eik);
-  set_vert_dl(eik);
-  set_tri_dlc(eik);
-  set_nb_dlc(eik);
-  set_nearby_dlc(eik);
+  for (int c = 0; c < NUM_CLASSES; ++c) {
+    set_nb_dl(eik, c);
+    set_cell_nb_verts_dl(eik, c);
+    set_vert_dl(eik, c);
+    set_tri_dlc(eik, c);
+    set_nb_dlc(eik, c);
+    set_nearby_dlc(eik, c);
+#if CELL_STORAGE == BAND_CELL_STORAGE
+    set_cell_user_dl(eik, c);
+#endif
+  }
 
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  for (int lc = 0; lc < eik->ncells; ++lc) {
+    eik->cell_slots[lc] = NO_INDEX;
+  }
+  eik->num_cell_slots = 0;
+  eik->free_cell_slots = NULL;
+  eik->num_free_cell_slots = 0;
+  eik->free_cell_slots_capacity = 0;
+#else
   for (int lc = 0; lc < eik->ncells; ++lc) {
     bicubic_invalidate(&eik->bicubics[lc]);
   }
+#endif
 
   for (int l = 0; l < eik->nnodes; ++l) {
-    eik->jets[l].f = INFINITY;
-    eik->jets[l].fx = NAN;
-    eik->jets[l].fy = NAN;
-    eik->jets[l].fxy = NAN;
+    JET(eik, l, f) = INFINITY;
+    JET(eik, l, fx) = NAN;
+    JET(eik, l, fy) = NAN;
+    JET(eik, l, fxy) = NAN;
   }
 
   for (int l = 0; l < eik->nnodes; ++l) {
     eik->states[l] = FAR;
   }
+
+  for (int l = 0; l < eik->nnodes; ++l) {
+    eik->warm_start_slots[l] = NO_INDEX;
+  }
+  eik->num_warm_start_slots = 0;
+  eik->free_warm_start_slots = NULL;
+  eik->num_free_warm_start_slots = 0;
+  eik->free_warm_start_slots_capacity = 0;
+
+  for (int l = 0; l < eik->nnodes; ++l) {
+    ivec2 ind = l2ind(eik->padded_shape, l);
+    if (ind.i < MARGIN || ind.i >= shape.i + MARGIN ||
+        ind.j < MARGIN || ind.j >= shape.j + MARGIN) {
+      eik->states[l] = BOUNDARY;
+    }
+  }
 }
 
 void eik_deinit(eik_s *eik) {
   eik->slow = NULL;
 
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  int num_chunks = (eik->num_cell_slots + CELL_CHUNK_SIZE - 1)/CELL_CHUNK_SIZE;
+  for (int k = 0; k < num_chunks; ++k) {
+    free(eik->cell_chunks[k]);
+  }
+  free(eik->cell_slots);
+  free(eik->cell_chunks);
+  free(eik->free_cell_slots);
+#else
   free(eik->bicubics);
+#endif
+#if JET_STORAGE == SOA_JET_STORAGE
+  free(eik->jets.f);
+  free(eik->jets.fx);
+  free(eik->jets.fy);
+  free(eik->jets.fxy);
+#else
   free(eik->jets);
+#endif
   free(eik->states);
   free(eik->positions);
-
+  free(eik->touched);
+  int num_warm_start_chunks =
+    (eik->num_warm_start_slots + WARM_START_CHUNK_SIZE - 1)/
+    WARM_START_CHUNK_SIZE;
+  for (int k = 0; k < num_warm_start_chunks; ++k) {
+    free(eik->warm_start_chunks[k]);
+  }
+  free(eik->warm_start_slots);
+  free(eik->warm_start_chunks);
+  free(eik->free_warm_start_slots);
+
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  eik->cell_slots = NULL;
+  eik->cell_chunks = NULL;
+  eik->free_cell_slots = NULL;
+#else
   eik->bicubics = NULL;
+#endif
+#if JET_STORAGE == SOA_JET_STORAGE
+  eik->jets = (jet_ptrs_s) {NULL, NULL, NULL, NULL};
+#else
   eik->jets = NULL;
+#endif
   eik->states = NULL;
   eik->positions = NULL;
+  eik->touched = NULL;
+  eik->warm_start_slots = NULL;
+  eik->warm_start_chunks = NULL;
+  eik->free_warm_start_slots = NULL;
 
   heap_deinit(eik->heap);
   heap_dealloc(&eik->heap);
@@ -763,43 +1446,50 @@ void eik_deinit(eik_s *eik) {
 static void check_cell_consistency(eik_s const *eik, int l0) {
   dbl tol = 1e-10, h = eik->h, h_sq = h*h, f, fx, fy, fxy;
   dvec2 cc[4] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
-  bicubic_s *bicubic;
+  bicubic_s tmp;
+  bicubic_s const *bicubic;
+  int const *nearby_dlc = eik->nearby_dlc[get_class(l0)];
   for (int ic = 0, lc; ic < NUM_NEARBY_CELLS; ++ic) {
-    lc = l2lc(eik->shape, l0) + eik->nearby_dlc[ic];
+    lc = l2lc(eik->padded_shape, l0) + nearby_dlc[ic];
     if (can_build_cell(eik, lc)) {
-      bicubic = &eik->bicubics[lc];
+      bicubic = get_cell(eik, lc, &tmp);
+      int l1 = lc2l(eik->padded_shape, lc);
+      int const *vert_dl = eik->vert_dl[get_class(l1)];
       for (int jv = 0, l; jv < NUM_CELL_VERTS; ++jv) {
-        l = lc2l(eik->shape, lc) + eik->vert_dl[jv];
+        l = l1 + vert_dl[jv];
         f = bicubic_f(bicubic, cc[jv]);
         fx = bicubic_fx(bicubic, cc[jv]);
         fy = bicubic_fy(bicubic, cc[jv]);
         fxy = bicubic_fxy(bicubic, cc[jv]);
-        assert(fabs(f - eik->jets[l].f) < tol);
-        assert(fabs(fx - h*eik->jets[l].fx) < tol);
-        assert(fabs(fy - h*eik->jets[l].fy) < tol);
-        assert(fabs(fxy - h_sq*eik->jets[l].fxy) < tol);
+        assert(fabs(f - JET(eik, l, f)) < tol);
+        assert(fabs(fx - h*JET(eik, l, fx)) < tol);
+        assert(fabs(fy - h*JET(eik, l, fy)) < tol);
+        assert(fabs(fxy - h_sq*JET(eik, l, fxy)) < tol);
       }
     }
   }
 }
 #endif
 
-void eik_step(eik_s *eik) {
-  int l0 = heap_front(eik->heap);
-  assert(eik->states[l0] == TRIAL);
-  heap_pop(eik->heap);
-  eik->states[l0] = VALID;
-
-  ivec2 ind0 = l2ind(eik->shape, l0);
+/**
+ * Once `l0` has become VALID (or its jet has changed, when
+ * sweeping), recompute the Txy values at the nodes surrounding it
+ * and rebuild the cells which use them (including the cells which
+ * just became valid).
+ */
+static void rebuild_cells(eik_s *eik, int l0) {
+  int c0 = get_class(l0);
+  int lc0 = l2lc(eik->padded_shape, l0);
+  int const *nearby_dlc = eik->nearby_dlc[c0];
 
   // Determine which of the cells surrounding l0 are now valid. It's
   // enough to check if any of the four nearest cells are valid: it's
   // impossible for them to have been valid (or built before), since
   // one of their vertices just became valid.
   bool valid_cell_nb[NUM_NB_CELLS];
-  for (int ic = 0; ic < NUM_NB_CELLS; ++ic) {
-    ivec2 indc = ivec2_add(ind0, nb_cell_offsets[ic]);
-    valid_cell_nb[ic] = cell_is_valid(eik, indc);
+  for (int ic = 0, lc; ic < NUM_NB_CELLS; ++ic) {
+    lc = lc0 + eik->nb_dlc[c0][ic];
+    valid_cell_nb[ic] = can_build_cell(eik, lc);
   }
 
   // TODO: don't build this inline?
@@ -822,9 +1512,7 @@ void eik_step(eik_s *eik) {
 
   // Traverse the nearby cells and figure out which should be used to
   // compute new Txy values.
-  //
-  // NOTE: `use_for_Txy_average` => the cell is inbounds
-  for (int ic = 0; ic < NUM_NEARBY_CELLS; ++ic) {
+  for (int ic = 0, lc; ic < NUM_NEARBY_CELLS; ++ic) {
     for (int j = 0, i; j < NUM_CELL_VERTS; ++j) {
       i = cell_verts_to_cell_nb_verts[ic][j];
       if (i == NO_INDEX) {
@@ -832,10 +1520,8 @@ void eik_step(eik_s *eik) {
       }
       use_for_Txy_average[ic] |= nb_incident_on_valid_cell_nb[i];
     }
-	{
-      ivec2 indc = ivec2_add(ind0, nearby_cell_offsets[ic]);
-      use_for_Txy_average[ic] &= cell_is_valid(eik, indc);
-	}
+    lc = lc0 + nearby_dlc[ic];
+    use_for_Txy_average[ic] &= can_build_cell(eik, lc);
   }
 
   // Compute new Txy values at the vertices of the cells that we
@@ -843,7 +1529,7 @@ void eik_step(eik_s *eik) {
   dvec4 Txy[NUM_NEARBY_CELLS];
   for (int ic = 0, lc; ic < NUM_NEARBY_CELLS; ++ic) {
     if (use_for_Txy_average[ic]) {
-      lc = l2lc(eik->shape, l0) + eik->nearby_dlc[ic];
+      lc = lc0 + nearby_dlc[ic];
       // If the cell is one of `l0`'s neighbors, then we have to use
       // bilinear extrapolation to compute its Txy values. Otherwise,
       // we can just grab the cell's existing Txy values.
@@ -872,8 +1558,8 @@ void eik_step(eik_s *eik) {
         }
       }
       if (nterms > 0) {
-        l = l0 + eik->cell_nb_verts_dl[i];
-        eik->jets[l].fxy = Txy_sum/nterms;
+        l = l0 + eik->cell_nb_verts_dl[c0][i];
+        JET(eik, l, fxy) = Txy_sum/nterms;
       }
     }
   }
@@ -883,14 +1569,37 @@ void eik_step(eik_s *eik) {
   // values, so we can just check `use_for_Txy_average` here.
   for (int ic = 0, lc; ic < NUM_NEARBY_CELLS; ++ic) {
     if (use_for_Txy_average[ic]) {
-      lc = l2lc(eik->shape, l0) + eik->nearby_dlc[ic];
+      lc = lc0 + nearby_dlc[ic];
       build_cell(eik, lc);
     }
   }
 
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  // Now that `l0` is VALID, the cells it would have read in `tri`
+  // may have fallen out of the band
+  for (int ic = 0, lc; ic < NUM_NB; ++ic) {
+    lc = lc0 + eik->tri_dlc[c0][ic];
+    if (eik->cell_slots[lc] != NO_INDEX && !cell_needed(eik, lc)) {
+      free_cell(eik, lc);
+    }
+  }
+#endif
+
 #if SJS_DEBUG
   check_cell_consistency(eik, l0);
 #endif
+}
+
+void eik_step(eik_s *eik) {
+  int l0 = heap_front(eik->heap);
+  assert(eik->states[l0] == TRIAL);
+  heap_pop(eik->heap);
+  eik->states[l0] = VALID;
+  free_warm_start(eik, l0);
+
+  rebuild_cells(eik, l0);
+
+  int c0 = get_class(l0);
 
   /**
    * The section below corresponds to what's done in a "normal"
@@ -899,27 +1608,40 @@ void eik_step(eik_s *eik) {
 
   // Set FAR nodes to TRIAL and insert them into the heap.
   for (int i = 0, l; i < NUM_NB; ++i) {
-    if (!inbounds(eik, ivec2_add(ind0, offsets[i]))) {
-      continue;
-    }
-    l = l0 + eik->nb_dl[i];
+    l = l0 + eik->nb_dl[c0][i];
     if (eik->states[l] == FAR) {
+      touch(eik, l);
       eik->states[l] = TRIAL;
       heap_insert(eik->heap, l);
     }
   }
 
-  // Update neighboring nodes.
+  // Update neighboring nodes. Each update only reads VALID nodes and
+  // writes to its own node, so they can be done in parallel (see
+  // `eik_set_parallel_updates`), but the heap has to be adjusted one
+  // node at a time afterwards.
+  int l_nb[NUM_NB], num_nb = 0;
   for (int i = 0, l; i < NUM_NB; ++i) {
-    if (!inbounds(eik, ivec2_add(ind0, offsets[i]))) {
-      continue;
-    }
-    l = l0 + eik->nb_dl[i];
+    l = l0 + eik->nb_dl[c0][i];
     if (eik->states[l] == TRIAL) {
-      update(eik, l);
-      adjust(eik, l);
+      l_nb[num_nb++] = l;
     }
   }
+  int num_threads = 1;
+  if (eik->parallel_updates && num_nb > 1) {
+    num_threads = omp_get_max_threads();
+    if (num_threads > num_nb) {
+      num_threads = num_nb;
+    }
+  }
+#pragma omp parallel for if (num_threads > 1) num_threads(num_threads) \
+  schedule(static, 1)
+  for (int k = 0; k < num_nb; ++k) {
+    update(eik, l_nb[k]);
+  }
+  for (int k = 0; k < num_nb; ++k) {
+    adjust(eik, l_nb[k]);
+  }
 }
 
 void eik_solve(eik_s *eik) {
@@ -928,119 +1650,1278 @@ void eik_solve(eik_s *eik) {
   }
 }
 
+/**
+ * Solve until every node with T <= Tmax is VALID. Since nodes are
+ * accepted in increasing order of T, this just stops once the front
+ * of the heap exceeds Tmax, leaving the rest of the front TRIAL so
+ * that the solve can be resumed later (e.g., by `eik_solve`).
+ */
+void eik_solve_until_T(eik_s *eik, dbl Tmax) {
+  while (heap_size(eik->heap) > 0 &&
+         JET(eik, heap_front(eik->heap), f) <= Tmax) {
+    eik_step(eik);
+  }
+}
+
+/**
+ * Solve until each of the `n` nodes in `targets` and each of the
+ * cells incident on them have been built, so that T and its
+ * derivatives can be interpolated near each target. This stops early
+ * if the heap runs out first (e.g., if a target can't be reached).
+ */
+void eik_solve_until_targets(eik_s *eik, ivec2 const *targets, int n) {
+  // A cell is built once all of its vertices are VALID (see
+  // `rebuild_cells`), so we need to wait for the 3x3 neighborhood of
+  // each target to be accepted.
+  int *needed = malloc(9*n*sizeof(int)), num_needed = 0;
+  assert(needed != NULL);
+  for (int k = 0; k < n; ++k) {
+    assert(0 <= targets[k].i && targets[k].i < eik->shape.i);
+    assert(0 <= targets[k].j && targets[k].j < eik->shape.j);
+    for (int di = -1; di <= 1; ++di) {
+      for (int dj = -1; dj <= 1; ++dj) {
+        ivec2 ind = {targets[k].i + di, targets[k].j + dj};
+        if (0 <= ind.i && ind.i < eik->shape.i &&
+            0 <= ind.j && ind.j < eik->shape.j) {
+          needed[num_needed++] = get_l(eik, ind);
+        }
+      }
+    }
+  }
+
+  // Rather than checking every needed node after each step, wait on
+  // them one at a time: a node that's VALID stays VALID, so each
+  // node only has to be skipped over once.
+  int k = 0;
+  while (heap_size(eik->heap) > 0) {
+    while (k < num_needed && (eik->states[needed[k]] == VALID ||
+                              eik->states[needed[k]] == BOUNDARY)) {
+      ++k;
+    }
+    if (k == num_needed) {
+      break;
+    }
+    eik_step(eik);
+  }
+
+  free(needed);
+}
+
+/**
+ * A tile used by `eik_solve_parallel`. The tile owns the nodes with
+ * `ind0 <= ind < ind1`, and is solved on a subdomain which extends
+ * `HALO` nodes past these (clipped to the domain), from `halo_ind0`
+ * to `halo_ind1`. Indices are into the domain (not padded). The
+ * subdomain is kept between rounds, along with the order in which
+ * its nodes were accepted and their jets just before that (see
+ * `solve_tile`).
+ */
+typedef struct tile {
+  ivec2 ind0, ind1, halo_ind0, halo_ind1;
+  eik_s *sub;
+  int *order;
+  jet_s *order_jets;
+  int num_order;
+  bool *kept;
+  dbl T_cut; // the nodes accepted below this are kept
+  eik_stats_s stats; // work done by `sub` before it was last reset
+} tile_s;
+
+/**
+ * The width of the halo surrounding each tile. Two nodes is enough
+ * for every stencil of an owned node to lie in the subdomain, but a
+ * slightly wider halo gives the halo nodes' Txy values (which are
+ * averaged over the cells surrounding each node) a chance to match
+ * the serial solver's before they're used by owned nodes.
+ */
+#define HALO 3
+
+/**
+ * A halo node counts as having changed (which makes its tile be
+ * solved again) if its T value changed by more than this, relative
+ * to its new value.
+ */
+#define PARALLEL_TOL 1e-13
+
+static void add_stats(eik_stats_s *stats, eik_stats_s const *other) {
+  stats->num_line_updates += other->num_line_updates;
+  stats->num_tri_updates += other->num_tri_updates;
+  stats->num_bfgs_iters += other->num_bfgs_iters;
+  stats->num_warm_starts += other->num_warm_starts;
+  stats->num_pruned_line_updates += other->num_pruned_line_updates;
+  stats->num_pruned_tri_updates += other->num_pruned_tri_updates;
+}
+
+static void init_tile(eik_s const *eik, tile_s *tile) {
+  ivec2 shape = {
+    .i = tile->halo_ind1.i - tile->halo_ind0.i,
+    .j = tile->halo_ind1.j - tile->halo_ind0.j
+  };
+  dvec2 xymin = {
+    .x = eik->xymin.x + eik->h*tile->halo_ind0.i,
+    .y = eik->xymin.y + eik->h*tile->halo_ind0.j
+  };
+
+  eik_alloc(&tile->sub);
+  eik_init(tile->sub, eik->slow, shape, xymin, eik->h);
+  tile->sub->use_newton = eik->use_newton;
+  // With warm starts, where the F4 iteration stops depends on the
+  // earlier updates of a node, so solving a tile again would move T
+  // by more than `PARALLEL_TOL` and the tiles would never settle.
+  tile->sub->use_warm_start = false;
+  tile->sub->s_min = eik->s_min;
+  tile->sub->discard_failed_updates = true;
+
+  tile->order = malloc(tile->sub->nnodes*sizeof(int));
+  tile->order_jets = malloc(tile->sub->nnodes*sizeof(jet_s));
+  tile->kept = malloc(tile->sub->nnodes*sizeof(bool));
+  assert(tile->order != NULL);
+  assert(tile->order_jets != NULL);
+  assert(tile->kept != NULL);
+  tile->num_order = 0;
+
+  tile->T_cut = -INFINITY;
+  tile->stats = (eik_stats_s) {0};
+}
+
+static void deinit_tile(tile_s *tile) {
+  eik_deinit(tile->sub);
+  eik_dealloc(&tile->sub);
+  free(tile->order);
+  free(tile->order_jets);
+  free(tile->kept);
+}
+
+static bool tile_owns(tile_s const *tile, ivec2 ind) {
+  return tile->ind0.i <= ind.i && ind.i < tile->ind1.i &&
+    tile->ind0.j <= ind.j && ind.j < tile->ind1.j;
+}
+
+/**
+ * Solve the subdomain of `tile` again, using the initial states and
+ * jets in `init_states` and `init_jets` for all nodes, and the
+ * current jets of `eik` (from the tiles that own them) for the halo
+ * nodes.
+ *
+ * Only the halo nodes whose values changed since the last solve can
+ * change the solution, and only the part of it accepted after them,
+ * so the nodes accepted before `tile->T_cut` (the smallest of their
+ * old and new values) are kept. To pick up where the last solve
+ * reached `T_cut`, these are made VALID again in the order they were
+ * accepted, using the jets they had just before, and `rebuild_cells`
+ * is called for each, which recomputes the same Txy values. Only
+ * the nodes that weren't kept are updated, so this is the same as
+ * solving from scratch, without most of the updates. The first time,
+ * `T_cut` is -inf, and nothing is kept.
+ */
+static void solve_tile(eik_s const *eik, tile_s *tile,
+                       state_e const *init_states, jet_s const *init_jets) {
+  eik_s *sub = tile->sub;
+
+  int num_kept = 0;
+  while (num_kept < tile->num_order &&
+         tile->order_jets[num_kept].f < tile->T_cut) {
+    ++num_kept;
+  }
+  for (int l = 0; l < sub->nnodes; ++l) {
+    tile->kept[l] = false;
+  }
+  for (int k = 0; k < num_kept; ++k) {
+    tile->kept[tile->order[k]] = true;
+  }
+
+  eik_stats_s stats = eik_get_stats(sub);
+  add_stats(&tile->stats, &stats);
+  eik_reset(sub);
+
+  // The TRIAL nodes aren't put into the heap until the kept nodes
+  // have been accepted again, since some of them are kept.
+  ivec2 ind, sub_ind;
+  for (ind.i = tile->halo_ind0.i; ind.i < tile->halo_ind1.i; ++ind.i) {
+    for (ind.j = tile->halo_ind0.j; ind.j < tile->halo_ind1.j; ++ind.j) {
+      sub_ind.i = ind.i - tile->halo_ind0.i;
+      sub_ind.j = ind.j - tile->halo_ind0.j;
+      int k = eik->shape.j*ind.i + ind.j, l = get_l(eik, ind);
+      int sub_l = get_l(sub, sub_ind);
+      bool owned = tile_owns(tile, ind);
+      jet_s jet;
+      if (init_states[k] == BOUNDARY) {
+        eik_make_bd(sub, sub_ind);
+        continue;
+      } else if (init_states[k] == VALID) {
+        eik_add_valid(sub, sub_ind, init_jets[k]);
+        continue;
+      } else if (owned && init_states[k] == TRIAL) {
+        jet = init_jets[k];
+      } else if (!owned && isfinite(JET(eik, l, f))) {
+        jet = get_jet(eik, l);
+      } else {
+        continue;
+      }
+      touch(sub, sub_l);
+      set_jet(sub, sub_l, jet);
+      sub->states[sub_l] = TRIAL;
+    }
+  }
+
+  eik_build_cells(sub);
+
+  for (int k = 0, l0; k < num_kept; ++k) {
+    l0 = tile->order[k];
+    if (sub->states[l0] == FAR) {
+      touch(sub, l0);
+    }
+    set_jet(sub, l0, tile->order_jets[k]);
+    sub->states[l0] = VALID;
+    rebuild_cells(sub, l0);
+
+    int const *nb_dl = sub->nb_dl[get_class(l0)];
+    for (int i = 0, l; i < NUM_NB; ++i) {
+      l = l0 + nb_dl[i];
+      if (tile->kept[l]) {
+        continue;
+      }
+      if (sub->states[l] == FAR) {
+        touch(sub, l);
+        sub->states[l] = TRIAL;
+      }
+      if (sub->states[l] == TRIAL) {
+        update(sub, l);
+      }
+    }
+  }
+
+  for (int l = 0; l < sub->nnodes; ++l) {
+    if (sub->states[l] == TRIAL) {
+      heap_insert(sub->heap, l);
+    }
+  }
+
+  tile->num_order = num_kept;
+  while (heap_size(sub->heap) > 0) {
+    int l = heap_front(sub->heap);
+    tile->order[tile->num_order] = l;
+    tile->order_jets[tile->num_order++] = get_jet(sub, l);
+    eik_step(sub);
+  }
+}
+
+/**
+ * Copy the jets of the nodes owned by `tile` from its subdomain back
+ * into `eik`. For each node whose value changed, store the smaller
+ * of its old and new values in `T_changed`.
+ */
+static void write_back_tile(eik_s *eik, tile_s const *tile,
+                            state_e const *init_states, dbl *T_changed) {
+  ivec2 ind, sub_ind;
+  for (ind.i = tile->ind0.i; ind.i < tile->ind1.i; ++ind.i) {
+    for (ind.j = tile->ind0.j; ind.j < tile->ind1.j; ++ind.j) {
+      int k = eik->shape.j*ind.i + ind.j, l = get_l(eik, ind);
+      // Initially VALID nodes are copied, too, since their Txy values
+      // may have been recomputed.
+      if (init_states[k] == BOUNDARY) {
+        continue;
+      }
+      sub_ind.i = ind.i - tile->halo_ind0.i;
+      sub_ind.j = ind.j - tile->halo_ind0.j;
+      jet_s jet = eik_get_jet(tile->sub, sub_ind);
+      dbl T = JET(eik, l, f);
+      if (jet.f != T && !(fabs(jet.f - T) <= PARALLEL_TOL*fabs(jet.f))) {
+        T_changed[k] = fmin(jet.f, T);
+      }
+      set_jet(eik, l, jet);
+    }
+  }
+}
+
+/**
+ * Find the smallest value in `T_changed` over the halo of `tile`.
+ */
+static dbl get_T_cut(eik_s const *eik, tile_s const *tile,
+                     dbl const *T_changed) {
+  dbl T_cut = INFINITY;
+  ivec2 ind;
+  for (ind.i = tile->halo_ind0.i; ind.i < tile->halo_ind1.i; ++ind.i) {
+    for (ind.j = tile->halo_ind0.j; ind.j < tile->halo_ind1.j; ++ind.j) {
+      if (!tile_owns(tile, ind)) {
+        T_cut = fmin(T_cut, T_changed[eik->shape.j*ind.i + ind.j]);
+      }
+    }
+  }
+  return T_cut;
+}
+
+/**
+ * Solve in parallel (using OpenMP) by splitting the domain into
+ * `num_tiles.i` by `num_tiles.j` tiles. Each tile is solved with its
+ * own heap on a subdomain which includes a halo of nodes owned by
+ * neighboring tiles, whose jets are taken from the neighbors' last
+ * solutions. This is repeated for each tile whose halo changed until
+ * none of them do. Only tiles whose halos changed are solved again,
+ * and only from just before the first node that changed (see
+ * `solve_tile`). Still, a front crossing the domain only keeps a few
+ * tiles busy at a time, and each of them is solved again whenever a
+ * neighbor's solution changes, so with a single source, the tiles do
+ * several times as many updates as `eik_solve` (see
+ * bench_parallel.sh): the most speedup comes from problems with many
+ * sources.
+ *
+ * Tiles exchange jets (including Txy) rather than cells, since cells
+ * are cheap to rebuild from their vertices' jets. Because the order
+ * in which nodes are accepted differs from `eik_solve` near the
+ * edges of the tiles, the Txy values there (and so T, Tx, etc.)
+ * differ slightly from the serial solver. For the point source
+ * problem in scratch.cpp, T, Tx, and Ty agree with `eik_solve` to
+ * within about 1e-10, and Txy to within about 1e-8. If the problem
+ * is symmetric, nodes mirrored across the line of symmetry are nearly
+ * tied, and the tiles may accept them in the other order, so the
+ * difference can be as large as the asymmetry of the solution.
+ *
+ * The tiles don't use warm starts (see `init_tile`), so these
+ * numbers are for `eik_solve` without them, too. With them,
+ * `eik_solve` moves by about 1e-11 in T and 1e-7 in Txy.
+ *
+ * Like `eik_solve`, this should be called after the initial data
+ * has been set up and `eik_build_cells` has been called. When it
+ * returns, every reachable node is VALID and every cell that can be
+ * built has been.
+ */
+void eik_solve_parallel(eik_s *eik, ivec2 num_tiles) {
+  assert(0 < num_tiles.i && num_tiles.i <= eik->shape.i);
+  assert(0 < num_tiles.j && num_tiles.j <= eik->shape.j);
+
+  int ntiles = num_tiles.i*num_tiles.j;
+  tile_s *tiles = malloc(ntiles*sizeof(tile_s));
+  assert(tiles != NULL);
+  for (int ti = 0; ti < num_tiles.i; ++ti) {
+    for (int tj = 0; tj < num_tiles.j; ++tj) {
+      tile_s *tile = &tiles[num_tiles.j*ti + tj];
+      tile->ind0.i = ti*eik->shape.i/num_tiles.i;
+      tile->ind0.j = tj*eik->shape.j/num_tiles.j;
+      tile->ind1.i = (ti + 1)*eik->shape.i/num_tiles.i;
+      tile->ind1.j = (tj + 1)*eik->shape.j/num_tiles.j;
+      tile->halo_ind0.i = tile->ind0.i < HALO ? 0 : tile->ind0.i - HALO;
+      tile->halo_ind0.j = tile->ind0.j < HALO ? 0 : tile->ind0.j - HALO;
+      tile->halo_ind1.i = tile->ind1.i + HALO > eik->shape.i ?
+        eik->shape.i : tile->ind1.i + HALO;
+      tile->halo_ind1.j = tile->ind1.j + HALO > eik->shape.j ?
+        eik->shape.j : tile->ind1.j + HALO;
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int k = 0; k < ntiles; ++k) {
+    init_tile(eik, &tiles[k]);
+  }
+
+  // Save the initial data before it's overwritten, since the tiles
+  // start over from it each time they're solved.
+  int n = eik->shape.i*eik->shape.j;
+  state_e *init_states = malloc(n*sizeof(state_e));
+  jet_s *init_jets = malloc(n*sizeof(jet_s));
+  dbl *T_changed = malloc(n*sizeof(dbl));
+  assert(init_states != NULL);
+  assert(init_jets != NULL);
+  assert(T_changed != NULL);
+
+  ivec2 ind;
+  for (ind.i = 0; ind.i < eik->shape.i; ++ind.i) {
+    for (ind.j = 0; ind.j < eik->shape.j; ++ind.j) {
+      int k = eik->shape.j*ind.i + ind.j, l = get_l(eik, ind);
+      init_states[k] = eik->states[l];
+      init_jets[k] = get_jet(eik, l);
+      T_changed[k] = INFINITY;
+    }
+  }
+
+  // Solve and write back in separate passes, since each tile reads
+  // its halo from the nodes the other tiles write.
+  bool any_dirty = true;
+  while (any_dirty) {
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < ntiles; ++k) {
+      if (tiles[k].T_cut < INFINITY) {
+        solve_tile(eik, &tiles[k], init_states, init_jets);
+      }
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < ntiles; ++k) {
+      if (tiles[k].T_cut < INFINITY) {
+        write_back_tile(eik, &tiles[k], init_states, T_changed);
+      }
+    }
+
+    any_dirty = false;
+    for (int k = 0; k < ntiles; ++k) {
+      tiles[k].T_cut = get_T_cut(eik, &tiles[k], T_changed);
+      any_dirty |= tiles[k].T_cut < INFINITY;
+    }
+    for (int k = 0; k < n; ++k) {
+      T_changed[k] = INFINITY;
+    }
+  }
+
+  for (int k = 0; k < ntiles; ++k) {
+    eik_stats_s stats = eik_get_stats(tiles[k].sub);
+    add_stats(&eik->stats, &tiles[k].stats);
+    add_stats(&eik->stats, &stats);
+    deinit_tile(&tiles[k]);
+  }
+
+  // Everything that was reached is now VALID, as after `eik_solve`.
+  while (heap_size(eik->heap) > 0) {
+    heap_pop(eik->heap);
+  }
+  for (ind.i = 0; ind.i < eik->shape.i; ++ind.i) {
+    for (ind.j = 0; ind.j < eik->shape.j; ++ind.j) {
+      int l = get_l(eik, ind);
+      if (eik->states[l] != BOUNDARY && isfinite(JET(eik, l, f))) {
+        if (eik->states[l] == FAR) {
+          touch(eik, l);
+        }
+        eik->states[l] = VALID;
+      }
+    }
+  }
+  eik_build_cells(eik);
+
+  free(tiles);
+  free(init_states);
+  free(init_jets);
+  free(T_changed);
+}
+
+/**
+ * Solve using a variant of the fast iterative method (FIM). Instead
+ * of a heap, there's a list of "active" (TRIAL) nodes. Each round,
+ * the active nodes whose VALID neighbors changed since they were
+ * last updated are updated in parallel (using OpenMP), and then the
+ * active nodes whose values are within `h*s_min/(2*sqrt2)` of the
+ * smallest active value are accepted together, marking the active
+ * nodes next to them to be updated in the next round.
+ *
+ * Plain FIM accepts a node once updating it no longer changes its
+ * value, and reactivates it if one of its neighbors changes later
+ * on. That doesn't work here: accepting a node rebuilds the cells
+ * around it using its Txy value, so a node accepted before one of
+ * its upwind neighbors poisons the cubics used by the nodes downwind
+ * of it, which makes the triangle updates fail. Instead, nodes are
+ * accepted in a band narrow enough that they can't depend on each
+ * other, so they never change after being accepted.
+ *
+ * The largest safe bucket width (`h*s_min/sqrt2`, see bucket.c)
+ * would do if an update were always at least that much larger than
+ * the nodes it's done from, but the scheme doesn't quite guarantee
+ * it: T is interpolated along the edge of a triangle update by a
+ * cubic, which can dip below its ends. With a rough slowness, this
+ * accepts nodes which `eik_solve` would have updated from each other
+ * first. For `scratch 129 -r`, T then differs from `eik_solve` by
+ * 2e-3 (about as much as it changes from N = 129 to N = 257), and
+ * by 3e-4 with half that band, which is used here.
+ *
+ * Even so, the nodes are updated once per round rather than once per
+ * accepted neighbor, and the Txy values near the nodes accepted in
+ * each round are averaged over cells which are rebuilt in a
+ * different order, so this doesn't agree with `eik_solve` to
+ * roundoff: T differs by about 4e-7 for `scratch 129`.
+ *
+ * A triangle update may also fail (it isn't causal, or F4 doesn't
+ * converge) if a node outside the band ends up below a node in it.
+ * Failed updates are discarded while this runs (see `tri`), and the
+ * node is updated again in the next round.
+ *
+ * A node next to several of the nodes accepted in a round is only
+ * updated once, so this does fewer updates than `eik_solve` on the
+ * problem in scratch.cpp, even on one thread (see bench_fim.sh). On the other hand, since the width of the band
+ * is set by the smallest value of the slowness on the grid, a rough
+ * slowness with a small minimum makes for many rounds with only a
+ * few nodes accepted in each.
+ *
+ * This should be called in place of `eik_solve`, after the initial
+ * data has been set up and `eik_build_cells` has been called.
+ */
+void eik_solve_fim(eik_s *eik) {
+  int n = eik->shape.i*eik->shape.j;
+
+  dbl s_min = INFINITY;
+#pragma omp parallel for reduction(min: s_min)
+  for (int k = 0; k < n; ++k) {
+    ivec2 ind = {.i = k/eik->shape.j, .j = k % eik->shape.j};
+    s_min = fmin(s_min, field2_f(eik->slow, get_xy(eik, get_l(eik, ind))));
+  }
+  dbl width = eik->h*s_min/(2*SQRT2);
+
+  int *active = malloc(n*sizeof(int));
+  int *next = malloc(n*sizeof(int));
+  int *updates = malloc(n*sizeof(int));
+  bool *failed = malloc(n*sizeof(bool));
+  bool *dirty = calloc(eik->nnodes, sizeof(bool));
+  assert(active != NULL);
+  assert(next != NULL);
+  assert(updates != NULL);
+  assert(failed != NULL);
+  assert(dirty != NULL);
+
+  int num_active = 0;
+  while (heap_size(eik->heap) > 0) {
+    active[num_active++] = heap_front(eik->heap);
+    heap_pop(eik->heap);
+  }
+
+  eik->discard_failed_updates = true;
+
+  int num_updates = 0;
+  while (num_active > 0) {
+    // A node can be accepted in the same round it's marked dirty, in
+    // which case it's no longer TRIAL.
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int k = 0; k < num_updates; ++k) {
+      failed[k] = eik->states[updates[k]] == TRIAL && !update(eik, updates[k]);
+    }
+
+    // The nodes whose updates failed stay dirty.
+    int num_failed = 0;
+    for (int k = 0; k < num_updates; ++k) {
+      if (failed[k]) {
+        updates[num_failed++] = updates[k];
+      } else {
+        dirty[updates[k]] = false;
+      }
+    }
+    num_updates = num_failed;
+
+    dbl T_min = INFINITY;
+    for (int k = 0; k < num_active; ++k) {
+      T_min = fmin(T_min, JET(eik, active[k], f));
+    }
+
+    int num_next = 0;
+    for (int k = 0, l0; k < num_active; ++k) {
+      l0 = active[k];
+      if (JET(eik, l0, f) > T_min + width) {
+        next[num_next++] = l0;
+        continue;
+      }
+
+      eik->states[l0] = VALID;
+      free_warm_start(eik, l0);
+      rebuild_cells(eik, l0);
+
+      int c0 = get_class(l0);
+      for (int i = 0, l; i < NUM_NB; ++i) {
+        l = l0 + eik->nb_dl[c0][i];
+        if (eik->states[l] == FAR) {
+          touch(eik, l);
+          eik->states[l] = TRIAL;
+          next[num_next++] = l;
+        }
+        if (eik->states[l] == TRIAL && !dirty[l]) {
+          dirty[l] = true;
+          updates[num_updates++] = l;
+        }
+      }
+    }
+
+    int *tmp = active;
+    active = next;
+    next = tmp;
+    num_active = num_next;
+  }
+
+  eik->discard_failed_updates = false;
+
+  free(active);
+  free(next);
+  free(updates);
+  free(failed);
+  free(dirty);
+}
+
+/**
+ * Sweep the nodes with `ind0 <= ind < ind1` in the order given by
+ * `dir` (bit 0 set: decreasing i, bit 1 set: decreasing j), updating
+ * each node which isn't `fixed` and is `dirty`, starting from its jet
+ * in `init_jets`. Returns the largest change in T or grad T.
+ */
+static dbl sweep_tile(eik_s *eik, ivec2 ind0, ivec2 ind1, int dir,
+                      bool const *fixed, jet_s const *init_jets,
+                      bool *dirty, dbl tol) {
+  dbl change = 0;
+  int di = dir & 1 ? -1 : 1, dj = dir & 2 ? -1 : 1;
+  ivec2 ind = {
+    .i = dir & 1 ? ind1.i - 1 : ind0.i,
+    .j = dir & 2 ? ind1.j - 1 : ind0.j
+  };
+  for (int j0 = ind.j; ind0.i <= ind.i && ind.i < ind1.i; ind.i += di) {
+    for (ind.j = j0; ind0.j <= ind.j && ind.j < ind1.j; ind.j += dj) {
+      int k = eik->shape.j*ind.i + ind.j, l = get_l(eik, ind);
+      if (fixed[l] || !dirty[k]) {
+        continue;
+      }
+      dirty[k] = false;
+
+      jet_s jet = get_jet(eik, l);
+      JET(eik, l, f) = init_jets[l].f;
+      JET(eik, l, fx) = init_jets[l].fx;
+      JET(eik, l, fy) = init_jets[l].fy;
+      update(eik, l);
+      if (isinf(JET(eik, l, f))) {
+        set_jet(eik, l, jet);
+        continue;
+      }
+      dbl dT = fabs(JET(eik, l, f) - jet.f);
+      dbl dTx = fabs(JET(eik, l, fx) - jet.fx);
+      dbl dTy = fabs(JET(eik, l, fy) - jet.fy);
+      if (dT == 0 && dTx == 0 && dTy == 0) {
+        continue;
+      }
+      change = fmax(change, fmax(dT, fmax(dTx, dTy)));
+
+      if (eik->states[l] == FAR) {
+        touch(eik, l);
+      }
+      eik->states[l] = VALID;
+      rebuild_cells(eik, l);
+
+      if (dT <= tol && dTx <= tol && dTy <= tol) {
+        continue;
+      }
+
+      // Rebuilding the cells changes the cubics used to update the
+      // nodes within two nodes of `l`
+      for (int i = ind.i - 2; i <= ind.i + 2; ++i) {
+        for (int j = ind.j - 2; j <= ind.j + 2; ++j) {
+          if (0 <= i && i < eik->shape.i && 0 <= j && j < eik->shape.j) {
+            dirty[eik->shape.j*i + j] = true;
+          }
+        }
+      }
+    }
+  }
+  return change;
+}
+
+/**
+ * Solve by fast sweeping: instead of accepting nodes in order, each
+ * node's jet is recomputed using `update` while sweeping over the
+ * grid in each of the four alternating orderings (Gauss-Seidel
+ * style), rebuilding the cells around it whenever it changes. This
+ * is repeated until a round of four sweeps changes T and grad T by
+ * no more than `tol`. The initially VALID nodes are left alone. The
+ * initially TRIAL nodes are recomputed starting from their initial
+ * jets, and the other nodes from scratch; like `eik_solve`, neither
+ * is updated from initially VALID nodes alone (see `is_fixed`).
+ *
+ * A node is only visited again once a node within two nodes of it
+ * (which might have changed the cubics used to update it) changed by
+ * more than `tol`. The Txy values are averaged over cells which are
+ * rebuilt in a different order than in `eik_solve`, so the two don't
+ * agree to roundoff, and a few nodes can keep switching between two
+ * nearly equal updates. So, sweeping also stops once a round doesn't
+ * reduce the change, in which case this returns false. Otherwise, it
+ * returns true once the change is within `tol`.
+ *
+ * For the problem in scratch.cpp with N = 129, sweeping to 1e-8
+ * converges, and T is within 4e-7 of `eik_solve` (without warm
+ * starts, which aren't used while sweeping). For a point source off
+ * the grid with s = 1 and N = 33 (see test_eik.py), sweeping
+ * converges to 1e-6 but stalls before 1e-8, and T is within 1e-6 of
+ * `eik_solve` either way. With `-r`, sweeping stalls at about 2e-4
+ * for any `tol` below that, and T differs from `eik_solve` by up to
+ * 3e-4: compared with N = 513, the error is 2.1e-3, instead of
+ * 1.9e-3. So, sweeping is only as accurate as `eik_solve` up to the
+ * change it stalls at, which should be checked against the
+ * discretization error when this returns false.
+ *
+ * Since each visit recomputes a node from all of its neighbors, this
+ * does several times as many updates as `eik_solve` (see
+ * bench_sweep.sh), but it needs no heap and can run in parallel: the
+ * domain is split into `num_tiles.i` by `num_tiles.j` tiles, and for
+ * each ordering, the tiles are swept in wavefront order, with every
+ * other tile along each anti-diagonal swept at the same time (using
+ * OpenMP), so that no two tiles touch the same nodes or cells. Each
+ * tile has to be at least four nodes wide for this to work. Use {1,
+ * 1} tiles to sweep serially.
+ *
+ * This should be called in place of `eik_solve`, after the initial
+ * data has been set up and `eik_build_cells` has been called.
+ */
+bool eik_solve_sweep(eik_s *eik, dbl tol, ivec2 num_tiles) {
+  assert(0 < num_tiles.i && 4*num_tiles.i <= eik->shape.i);
+  assert(0 < num_tiles.j && 4*num_tiles.j <= eik->shape.j);
+
+  int n = eik->shape.i*eik->shape.j;
+  bool *fixed = malloc(eik->nnodes*sizeof(bool));
+  jet_s *init_jets = malloc(eik->nnodes*sizeof(jet_s));
+  bool *dirty = malloc(n*sizeof(bool));
+  assert(fixed != NULL);
+  assert(init_jets != NULL);
+  assert(dirty != NULL);
+  for (int l = 0; l < eik->nnodes; ++l) {
+    fixed[l] = eik->states[l] == VALID || eik->states[l] == BOUNDARY;
+    init_jets[l] = eik->states[l] == TRIAL ?
+      get_jet(eik, l) : (jet_s) {INFINITY, NAN, NAN, NAN};
+  }
+  for (int k = 0; k < n; ++k) {
+    dirty[k] = true;
+  }
+
+  while (heap_size(eik->heap) > 0) {
+    int l0 = heap_front(eik->heap);
+    heap_pop(eik->heap);
+    eik->states[l0] = VALID;
+    free_warm_start(eik, l0);
+    rebuild_cells(eik, l0);
+  }
+
+  eik->sweeping = true;
+  eik->fixed = fixed;
+  eik->discard_failed_updates = true;
+
+  dbl change = INFINITY, prev_change;
+  do {
+    prev_change = change;
+    change = 0;
+    for (int dir = 0; dir < 4; ++dir) {
+      for (int d = 0; d < num_tiles.i + num_tiles.j - 1; ++d) {
+        for (int parity = 0; parity < 2; ++parity) {
+#pragma omp parallel for schedule(dynamic) reduction(max: change)
+          for (int ti = parity; ti < num_tiles.i; ti += 2) {
+            int tj = d - ti;
+            if (tj < 0 || tj >= num_tiles.j) {
+              continue;
+            }
+            int ti_ = dir & 1 ? num_tiles.i - 1 - ti : ti;
+            int tj_ = dir & 2 ? num_tiles.j - 1 - tj : tj;
+            ivec2 ind0 = {
+              .i = ti_*eik->shape.i/num_tiles.i,
+              .j = tj_*eik->shape.j/num_tiles.j
+            };
+            ivec2 ind1 = {
+              .i = (ti_ + 1)*eik->shape.i/num_tiles.i,
+              .j = (tj_ + 1)*eik->shape.j/num_tiles.j
+            };
+            change = fmax(
+              change,
+              sweep_tile(eik, ind0, ind1, dir, fixed, init_jets, dirty, tol));
+          }
+        }
+      }
+    }
+  } while (change > tol && !(isfinite(change) && change >= prev_change));
+
+  eik->sweeping = false;
+  eik->fixed = NULL;
+  eik->discard_failed_updates = false;
+
+  free(fixed);
+  free(init_jets);
+  free(dirty);
+
+  return change <= tol;
+}
+
+/**
+ * Set up a point source at `ind0` by making the nodes within `r`
+ * nodes of it VALID and the nodes within `r + 1` nodes of it TRIAL.
+ * Their jets assume the rays near the source are straight, using
+ * the trapezoid rule for T and taking grad T to have length `s(x)`
+ * and to point away from the source. This is exact if the slowness
+ * is constant, and otherwise much more accurate than `s(x0)*|x -
+ * x0|` (about 20 times, for the linear speed in scratch.cpp).
+ */
+static void add_point_source(eik_s *eik, ivec2 ind0, dbl r) {
+  int const R = (int) ceil(r + 1);
+  dvec2 xy0 = get_xy(eik, get_l(eik, ind0));
+  dbl s0 = field2_f(eik->slow, xy0);
+  ivec2 ind;
+  for (ind.i = ind0.i - R; ind.i <= ind0.i + R; ++ind.i) {
+    for (ind.j = ind0.j - R; ind.j <= ind0.j + R; ++ind.j) {
+      if (ind.i < 0 || ind.i >= eik->shape.i ||
+          ind.j < 0 || ind.j >= eik->shape.j) {
+        continue;
+      }
+      int di = ind.i - ind0.i, dj = ind.j - ind0.j;
+      dbl d = sqrt(di*di + dj*dj);
+      if (d > r + 1) {
+        continue;
+      }
+      jet_s jet = {0, 0, 0, 0};
+      if (d > 0) {
+        dvec2 xy = get_xy(eik, get_l(eik, ind));
+        dvec2 dxy = dvec2_sub(xy, xy0);
+        dbl L = dvec2_norm(dxy), L_cubed = L*L*L;
+        dbl s = field2_f(eik->slow, xy);
+        dvec2 grad_s = field2_grad_f(eik->slow, xy);
+        jet.f = L*(s0 + s)/2;
+        jet.fx = s*dxy.x/L;
+        jet.fy = s*dxy.y/L;
+        jet.fxy = grad_s.y*dxy.x/L - s*dxy.x*dxy.y/L_cubed;
+      }
+      if (d <= r) {
+        eik_add_valid(eik, ind, jet);
+      } else {
+        eik_add_trial(eik, ind, jet);
+      }
+    }
+  }
+}
+
+/**
+ * Solve `num_sources` point source problems on the same grid and
+ * with the same slowness, one for each of the nodes in `sources`
+ * (see `add_point_source` for how each is set up, using a disk of
+ * initial data with a radius of `r >= 2` nodes).
+ *
+ * The problems are solved concurrently using OpenMP: each thread
+ * allocates one `eik` and reuses it for each of the problems it
+ * solves, so nothing is reallocated between problems. The results
+ * are written to `out`, each of whose members should either be
+ * NULL or point to a `num_sources` by `shape.i` by `shape.j` array
+ * in row-major order.
+ */
+void eik_batch(field2_s const *slow, ivec2 shape, dvec2 xymin, dbl h,
+               int num_sources, ivec2 const *sources, dbl r,
+               jet_ptrs_s out) {
+  assert(r >= 2);
+
+  size_t n = shape.i*shape.j;
+
+#pragma omp parallel
+  {
+    eik_s *eik;
+    eik_alloc(&eik);
+    eik_init(eik, slow, shape, xymin, h);
+
+#pragma omp for schedule(dynamic)
+    for (int k = 0; k < num_sources; ++k) {
+      eik_reset(eik);
+      add_point_source(eik, sources[k], r);
+      eik_build_cells(eik);
+      eik_solve(eik);
+
+      ivec2 ind;
+      for (ind.i = 0; ind.i < shape.i; ++ind.i) {
+        for (ind.j = 0; ind.j < shape.j; ++ind.j) {
+          int l = get_l(eik, ind);
+          size_t m = k*n + shape.j*ind.i + ind.j;
+          if (out.f) out.f[m] = JET(eik, l, f);
+          if (out.fx) out.fx[m] = JET(eik, l, fx);
+          if (out.fy) out.fy[m] = JET(eik, l, fy);
+          if (out.fxy) out.fxy[m] = JET(eik, l, fxy);
+        }
+      }
+    }
+
+    eik_deinit(eik);
+    eik_dealloc(&eik);
+  }
+}
+
 void eik_add_trial(eik_s *eik, ivec2 ind, jet_s jet) {
-  int l = ind2l(eik->shape, ind);
-  eik->jets[l] = jet;
+  int l = get_l(eik, ind);
   assert(eik->states[l] != TRIAL && eik->states[l] != VALID);
+  if (eik->states[l] == FAR) {
+    touch(eik, l);
+  }
+  set_jet(eik, l, jet);
   eik->states[l] = TRIAL;
   heap_insert(eik->heap, l);
 }
 
 void eik_add_valid(eik_s *eik, ivec2 ind, jet_s jet) {
-  int l = ind2l(eik->shape, ind);
-  eik->jets[l] = jet;
+  int l = get_l(eik, ind);
   assert(eik->states[l] != TRIAL && eik->states[l] != VALID);
+  if (eik->states[l] == FAR) {
+    touch(eik, l);
+  }
+  set_jet(eik, l, jet);
   eik->states[l] = VALID;
 }
 
 void eik_make_bd(eik_s *eik, ivec2 ind) {
-  int l = ind2l(eik->shape, ind);
+  int l = get_l(eik, ind);
+  if (eik->states[l] == FAR) {
+    touch(eik, l);
+  }
   eik->states[l] = BOUNDARY;
 }
 
+/**
+ * Reset `eik` to the state it was in right after `eik_init`, so that
+ * it can be used to solve another problem on the same grid without
+ * reallocating anything. Only the nodes which were touched since
+ * `eik` was initialized (or last reset) and the cells incident on
+ * them are reset, so this takes time proportional to the size of the
+ * last solve, not the size of the grid. Any settings (e.g.,
+ * `eik_set_use_newton`) are kept, but the stats are zeroed.
+ */
+void eik_reset(eik_s *eik) {
+  while (heap_size(eik->heap) > 0) {
+    heap_pop(eik->heap);
+  }
+
+  for (int k = 0, l; k < eik->num_touched; ++k) {
+    l = eik->touched[k];
+    JET(eik, l, f) = INFINITY;
+    JET(eik, l, fx) = NAN;
+    JET(eik, l, fy) = NAN;
+    JET(eik, l, fxy) = NAN;
+    eik->states[l] = FAR;
+    free_warm_start(eik, l);
+    int lc = l2lc(eik->padded_shape, l), c = get_class(l);
+    for (int i = 0; i < NUM_NB_CELLS; ++i) {
+      free_cell(eik, lc + eik->nb_dlc[c][i]);
+    }
+  }
+  eik->num_touched = 0;
+
+  eik->stats = (eik_stats_s) {0};
+}
+
 ivec2 eik_get_shape(eik_s const *eik) {
   return eik->shape;
 }
 
 jet_s eik_get_jet(eik_s *eik, ivec2 ind) {
-  int l = ind2l(eik->shape, ind);
-  return eik->jets[l];
+  int l = get_l(eik, ind);
+  return get_jet(eik, l);
 }
 
+/**
+ * Returns a pointer to the jet at index (0, 0) of the domain. Since
+ * the grid is padded, use `eik_get_strides` to index the rest of
+ * the jets (and the states returned by `eik_get_states_ptr`). This
+ * is only available with AOS_JET_STORAGE.
+ */
 jet_s *eik_get_jets_ptr(eik_s const *eik) {
-  return eik->jets;
+#if JET_STORAGE == SOA_JET_STORAGE
+  (void)eik;
+  assert(false); // use `eik_get_jet_ptrs` instead
+  return NULL;
+#else
+  return &eik->jets[get_l(eik, (ivec2) {0, 0})];
+#endif
+}
+
+/**
+ * Returns pointers to the `f`, `fx`, `fy`, and `fxy` values of the jet
+ * at index (0, 0) of the domain. This works for either `JET_STORAGE`:
+ * use `eik_get_jet_strides` to index the rest of the values.
+ */
+jet_ptrs_s eik_get_jet_ptrs(eik_s const *eik) {
+  int l = get_l(eik, (ivec2) {0, 0});
+  jet_ptrs_s ptrs = {
+    .f = &JET(eik, l, f),
+    .fx = &JET(eik, l, fx),
+    .fy = &JET(eik, l, fy),
+    .fxy = &JET(eik, l, fxy)
+  };
+  return ptrs;
 }
 
 state_e eik_get_state(eik_s const *eik, ivec2 ind) {
-  int l = ind2l(eik->shape, ind);
+  int l = get_l(eik, ind);
   return eik->states[l];
 }
 
 state_e *eik_get_states_ptr(eik_s const *eik) {
-  return eik->states;
+  return &eik->states[get_l(eik, (ivec2) {0, 0})];
+}
+
+/**
+ * Returns the number of elements between consecutive nodes along
+ * each axis in the arrays returned by `eik_get_jets_ptr` and
+ * `eik_get_states_ptr`. A tiled layout (`TILED_ORDERING`) can't be
+ * described by strides, so this can't be used in that case: use
+ * `eik_get_jet` and `eik_get_state` instead.
+ */
+ivec2 eik_get_strides(eik_s const *eik) {
+  assert(ORDERING != TILED_ORDERING);
+  ivec2 strides = {
+    .i = ind2l(eik->padded_shape, (ivec2) {1, 0}),
+    .j = ind2l(eik->padded_shape, (ivec2) {0, 1})
+  };
+  return strides;
+}
+
+/**
+ * Returns the number of `dbl`s between the values of consecutive
+ * nodes along each axis for the pointers returned by
+ * `eik_get_jet_ptrs`. With SOA_JET_STORAGE, `.j` is 1, so each row
+ * of values is contiguous.
+ */
+ivec2 eik_get_jet_strides(eik_s const *eik) {
+  ivec2 strides = eik_get_strides(eik);
+#if JET_STORAGE == AOS_JET_STORAGE
+  strides.i *= sizeof(jet_s)/sizeof(dbl);
+  strides.j *= sizeof(jet_s)/sizeof(dbl);
+#endif
+  return strides;
+}
+
+/**
+ * Like `eik_get_strides`, but for the array of cells returned by
+ * `eik_get_bicubics_ptr`.
+ */
+ivec2 eik_get_cell_strides(eik_s const *eik) {
+  assert(ORDERING != TILED_ORDERING);
+  ivec2 strides = {
+    .i = ind2lc(eik->padded_shape, (ivec2) {1, 0}),
+    .j = ind2lc(eik->padded_shape, (ivec2) {0, 1})
+  };
+  return strides;
 }
 
 /**
  * The four functions below (`eik_T`, `eik_Tx`, `eik_Ty`, and
  * `eik_Txy`) are only intended to be used by people consuming this
  * API, not internally.
- *
- * TODO: at some point, we're going to want to add batch versions of
- * these functions to avoid calling `can_build_cell` over and over.
+ * Batch versions of each of them follow.
+ */
+
+/**
+ * Find the cell containing `xy` (see `xy_to_lc_and_cc`), returning
+ * `NO_INDEX` if `xy` isn't finite.
  */
+static int get_lc_and_cc(eik_s const *eik, dvec2 xy, dvec2 *cc) {
+  int lc = xy_to_lc_and_cc(eik->shape, eik->xymin, eik->h, xy, cc);
+  if (lc == NO_INDEX) {
+    return NO_INDEX;
+  }
+  return get_lc(eik, lc2indc(eik->shape, lc));
+}
 
 dbl eik_T(eik_s *eik, dvec2 xy) {
   dvec2 cc;
-  int lc = xy_to_lc_and_cc(eik->shape, eik->xymin, eik->h, xy, &cc);
-  if (!can_build_cell(eik, lc)) {
+  int lc = get_lc_and_cc(eik, xy, &cc);
+  if (lc == NO_INDEX || !can_build_cell(eik, lc)) {
     return NAN;
   }
-  bicubic_s *bicubic = &eik->bicubics[lc];
+  bicubic_s tmp;
+  bicubic_s const *bicubic = get_cell(eik, lc, &tmp);
   return bicubic_f(bicubic, cc);
 }
 
 dbl eik_Tx(eik_s *eik, dvec2 xy) {
   dvec2 cc;
-  int lc = xy_to_lc_and_cc(eik->shape, eik->xymin, eik->h, xy, &cc);
-  if (!can_build_cell(eik, lc)) {
+  int lc = get_lc_and_cc(eik, xy, &cc);
+  if (lc == NO_INDEX || !can_build_cell(eik, lc)) {
     return NAN;
   }
-  bicubic_s *bicubic = &eik->bicubics[lc];
+  bicubic_s tmp;
+  bicubic_s const *bicubic = get_cell(eik, lc, &tmp);
   return bicubic_fx(bicubic, cc)/eik->h;
 }
 
 dbl eik_Ty(eik_s *eik, dvec2 xy) {
   dvec2 cc;
-  int lc = xy_to_lc_and_cc(eik->shape, eik->xymin, eik->h, xy, &cc);
-  if (!can_build_cell(eik, lc)) {
+  int lc = get_lc_and_cc(eik, xy, &cc);
+  if (lc == NO_INDEX || !can_build_cell(eik, lc)) {
     return NAN;
   }
-  bicubic_s *bicubic = &eik->bicubics[lc];
+  bicubic_s tmp;
+  bicubic_s const *bicubic = get_cell(eik, lc, &tmp);
   return bicubic_fy(bicubic, cc)/eik->h;
 }
 
 dbl eik_Txy(eik_s *eik, dvec2 xy) {
   dvec2 cc;
-  int lc = xy_to_lc_and_cc(eik->shape, eik->xymin, eik->h, xy, &cc);
-  if (!can_build_cell(eik, lc)) {
+  int lc = get_lc_and_cc(eik, xy, &cc);
+  if (lc == NO_INDEX || !can_build_cell(eik, lc)) {
     return NAN;
   }
-  bicubic_s *bicubic = &eik->bicubics[lc];
+  bicubic_s tmp;
+  bicubic_s const *bicubic = get_cell(eik, lc, &tmp);
   return bicubic_fxy(bicubic, cc)/(eik->h*eik->h);
 }
 
+/**
+ * Evaluate T and its derivatives at the `n` points `xy`, storing
+ * them in whichever of the pointers in `out` aren't NULL, with
+ * `stride` dbls between consecutive values. The cell of the last
+ * point is remembered, so if points in the same cell are adjacent
+ * (e.g., if they're sampled from a raster) most of the calls to
+ * `can_build_cell` are skipped.
+ *
+ * Points outside the grid are evaluated at the nearest point on its
+ * boundary, and the values at points which aren't finite are NaN.
+ */
+static void query_batch(eik_s *eik, dvec2 const *xy, int n, jet_ptrs_s out,
+                        int stride) {
+  bool only_f = !out.fx && !out.fy && !out.fxy;
+  dbl h = eik->h, h_sq = h*h;
+
+  int lc_prev = NO_INDEX;
+  bool valid = false;
+  bicubic_s tmp;
+  bicubic_s const *bicubic = NULL;
+  for (int k = 0; k < n; ++k) {
+    dvec2 cc;
+    int lc = get_lc_and_cc(eik, xy[k], &cc);
+    if (lc != lc_prev) {
+      valid = lc != NO_INDEX && can_build_cell(eik, lc);
+      if (valid) {
+        bicubic = get_cell(eik, lc, &tmp);
+      }
+      lc_prev = lc;
+    }
+
+    jet_s jet = {NAN, NAN, NAN, NAN};
+    if (valid && only_f) {
+      jet.f = bicubic_f(bicubic, cc);
+    } else if (valid) {
+      jet = bicubic_get_jet(bicubic, cc);
+    }
+
+    if (out.f) out.f[stride*k] = jet.f;
+    if (out.fx) out.fx[stride*k] = jet.fx/h;
+    if (out.fy) out.fy[stride*k] = jet.fy/h;
+    if (out.fxy) out.fxy[stride*k] = jet.fxy/h_sq;
+  }
+}
+
+void eik_T_batch(eik_s *eik, dvec2 const *xy, int n, dbl *T) {
+  query_batch(eik, xy, n, (jet_ptrs_s) {.f = T}, 1);
+}
+
+void eik_Tx_batch(eik_s *eik, dvec2 const *xy, int n, dbl *Tx) {
+  query_batch(eik, xy, n, (jet_ptrs_s) {.fx = Tx}, 1);
+}
+
+void eik_Ty_batch(eik_s *eik, dvec2 const *xy, int n, dbl *Ty) {
+  query_batch(eik, xy, n, (jet_ptrs_s) {.fy = Ty}, 1);
+}
+
+void eik_Txy_batch(eik_s *eik, dvec2 const *xy, int n, dbl *Txy) {
+  query_batch(eik, xy, n, (jet_ptrs_s) {.fxy = Txy}, 1);
+}
+
+/**
+ * Evaluate T, Tx, Ty, and Txy at each of the `n` points `xy` in one
+ * pass, storing them in `jets`.
+ */
+void eik_jet_batch(eik_s *eik, dvec2 const *xy, int n, jet_s *jets) {
+  jet_ptrs_s out = {&jets[0].f, &jets[0].fx, &jets[0].fy, &jets[0].fxy};
+  query_batch(eik, xy, n, out, sizeof(jet_s)/sizeof(dbl));
+}
+
 bool eik_can_build_cell(eik_s const *eik, ivec2 indc) {
-  int lc = indc2lc(eik->shape, indc);
+  int lc = get_lc(eik, indc);
   return can_build_cell(eik, lc);
 }
 
 void eik_build_cells(eik_s *eik) {
-  for (int lc = 0; lc < eik->ncells; ++lc) {
-    if (can_build_cell(eik, lc)) {
-      build_cell(eik, lc);
+  ivec2 indc;
+  for (indc.i = 0; indc.i < eik->padded_shape.i - 1; ++indc.i) {
+    for (indc.j = 0; indc.j < eik->padded_shape.j - 1; ++indc.j) {
+      int lc = indc2lc(eik->padded_shape, indc);
+      if (can_build_cell(eik, lc)) {
+        build_cell(eik, lc);
+      }
     }
   }
 }
 
 bicubic_s eik_get_bicubic(eik_s const *eik, ivec2 indc) {
-  int lc = indc2lc(eik->shape, indc);
-  return eik->bicubics[lc];
+  int lc = get_lc(eik, indc);
+  bicubic_s tmp;
+  return *get_cell(eik, lc, &tmp);
 }
 
+/**
+ * Returns a pointer to the cell at index (0, 0) of the domain. Use
+ * `eik_get_cell_strides` to index the rest of the cells. This is
+ * only available with DENSE_CELL_STORAGE.
+ */
 bicubic_s *eik_get_bicubics_ptr(eik_s const *eik) {
-  return eik->bicubics;
+#if CELL_STORAGE == BAND_CELL_STORAGE
+  (void)eik;
+  assert(false); // use `eik_get_bicubic` instead
+  return NULL;
+#else
+  return &eik->bicubics[get_lc(eik, (ivec2) {0, 0})];
+#endif
 }
 
 heap_s *eik_get_heap(eik_s const *eik) {
   return eik->heap;
 }
+
+/**
+ * Minimize F4 in triangle updates using Newton's method instead of
+ * a quasi-Newton (DFP) method. This requires the slowness to have a
+ * Hessian (see `field2_s`).
+ */
+void eik_set_use_newton(eik_s *eik, bool use_newton) {
+  assert(!use_newton || field2_has_hess(eik->slow));
+  eik->use_newton = use_newton;
+}
+
+bool eik_get_use_newton(eik_s const *eik) {
+  return eik->use_newton;
+}
+
+/**
+ * Start each triangle update of a TRIAL node from the minimizer and
+ * inverse Hessian that the last update of the node from the same
+ * triangle converged to, instead of from scratch. This saves a few
+ * iterations per update at the cost of keeping these around for each
+ * TRIAL node. It's on by default. Since the minimizations converge
+ * to a tolerance, the solution can change in the last few digits.
+ */
+void eik_set_use_warm_start(eik_s *eik, bool use_warm_start) {
+  eik->use_warm_start = use_warm_start;
+}
+
+bool eik_get_use_warm_start(eik_s const *eik) {
+  return eik->use_warm_start;
+}
+
+/**
+ * Set a lower bound on the slowness over the domain. Before doing a
+ * line or triangle update, `update` uses this to bound the new value
+ * from below, and skips the update if it can't improve on the value
+ * it has so far (see `line` and `tri_lower_bound`). The bounds hold
+ * for any slowness with the default of zero, but the closer this is
+ * to the actual minimum of the slowness, the more updates are
+ * skipped. If it's too large, updates which would have improved on
+ * the solution will be skipped, too.
+ */
+void eik_set_s_min(eik_s *eik, dbl s_min) {
+  assert(s_min >= 0);
+  eik->s_min = s_min;
+}
+
+dbl eik_get_s_min(eik_s const *eik) {
+  return eik->s_min;
+}
+
+/**
+ * Update the TRIAL neighbors of each node accepted by `eik_step` in
+ * parallel (using OpenMP) instead of one at a time, using at most
+ * `omp_get_max_threads()` threads. There are at most eight of them,
+ * each doing up to eight triangle updates and eight line updates, so
+ * this only pays off when updates are expensive (e.g., if the
+ * slowness is expensive to evaluate). The solution is the same
+ * either way.
+ *
+ * Starting a parallel region for each accepted node isn't free. For
+ * the problem in scratch.cpp with N = 257, on a machine with a single
+ * core (so there's no speedup to be had), always using one thread
+ * per neighbor took 5.6 s instead of 3.5 s, and OMP_NUM_THREADS=4
+ * took 4.7 s. With only one thread available (the default with one
+ * core), the neighbors are updated serially, and this took 3.4 s.
+ */
+void eik_set_parallel_updates(eik_s *eik, bool parallel_updates) {
+  eik->parallel_updates = parallel_updates;
+}
+
+bool eik_get_parallel_updates(eik_s const *eik) {
+  return eik->parallel_updates;
+}
+
+eik_stats_s eik_get_stats(eik_s const *eik) {
+  return eik->stats;
+}
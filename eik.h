@@ -14,29 +14,68 @@ extern "C" {
 
 typedef struct eik eik_s;
 
+/**
+ * Counts of the work done by an `eik_s` so far.
+ */
+typedef struct eik_stats {
+  long num_line_updates;
+  long num_tri_updates;
+  long num_bfgs_iters; // total number of iterations minimizing F4
+  long num_warm_starts; // triangle updates which were warm started
+  long num_pruned_line_updates; // skipped since they couldn't improve T
+  long num_pruned_tri_updates;
+} eik_stats_s;
+
 void eik_alloc(eik_s **eik);
 void eik_dealloc(eik_s **eik);
 void eik_init(eik_s *eik, field2_s const *slow, ivec2 shape, dvec2 xymin, dbl h);
 void eik_deinit(eik_s *eik);
 void eik_step(eik_s *eik);
 void eik_solve(eik_s *eik);
+void eik_solve_until_T(eik_s *eik, dbl Tmax);
+void eik_solve_until_targets(eik_s *eik, ivec2 const *targets, int n);
+void eik_solve_parallel(eik_s *eik, ivec2 num_tiles);
+void eik_solve_fim(eik_s *eik);
+bool eik_solve_sweep(eik_s *eik, dbl tol, ivec2 num_tiles);
+void eik_batch(field2_s const *slow, ivec2 shape, dvec2 xymin, dbl h,
+               int num_sources, ivec2 const *sources, dbl r,
+               jet_ptrs_s out);
 void eik_add_trial(eik_s *eik, ivec2 ind, jet_s jet);
 void eik_add_valid(eik_s *eik, ivec2 ind, jet_s jet);
 void eik_make_bd(eik_s *eik, ivec2 ind);
+void eik_reset(eik_s *eik);
 ivec2 eik_get_shape(eik_s const *eik);
 jet_s eik_get_jet(eik_s *eik, ivec2 ind);
 jet_s *eik_get_jets_ptr(eik_s const *eik);
+jet_ptrs_s eik_get_jet_ptrs(eik_s const *eik);
 state_e eik_get_state(eik_s const *eik, ivec2 ind);
 state_e *eik_get_states_ptr(eik_s const *eik);
+ivec2 eik_get_strides(eik_s const *eik);
+ivec2 eik_get_jet_strides(eik_s const *eik);
+ivec2 eik_get_cell_strides(eik_s const *eik);
 dbl eik_T(eik_s *eik, dvec2 xy);
 dbl eik_Tx(eik_s *eik, dvec2 xy);
 dbl eik_Ty(eik_s *eik, dvec2 xy);
 dbl eik_Txy(eik_s *eik, dvec2 xy);
+void eik_T_batch(eik_s *eik, dvec2 const *xy, int n, dbl *T);
+void eik_Tx_batch(eik_s *eik, dvec2 const *xy, int n, dbl *Tx);
+void eik_Ty_batch(eik_s *eik, dvec2 const *xy, int n, dbl *Ty);
+void eik_Txy_batch(eik_s *eik, dvec2 const *xy, int n, dbl *Txy);
+void eik_jet_batch(eik_s *eik, dvec2 const *xy, int n, jet_s *jets);
 bool eik_can_build_cell(eik_s const *eik, ivec2 indc);
 void eik_build_cells(eik_s *eik);
 bicubic_s eik_get_bicubic(eik_s const *eik, ivec2 indc);
 bicubic_s *eik_get_bicubics_ptr(eik_s const *eik);
 heap_s *eik_get_heap(eik_s const *eik);
+void eik_set_use_newton(eik_s *eik, bool use_newton);
+bool eik_get_use_newton(eik_s const *eik);
+void eik_set_use_warm_start(eik_s *eik, bool use_warm_start);
+bool eik_get_use_warm_start(eik_s const *eik);
+void eik_set_s_min(eik_s *eik, dbl s_min);
+dbl eik_get_s_min(eik_s const *eik);
+void eik_set_parallel_updates(eik_s *eik, bool parallel_updates);
+bool eik_get_parallel_updates(eik_s const *eik);
+eik_stats_s eik_get_stats(eik_s const *eik);
 
 #ifdef __cplusplus
 }
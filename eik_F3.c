@@ -1,5 +1,7 @@
 #include "eik_F3.h"
 
+#include <assert.h>
+
 // TODO: change naming conventions to make this take up less space:
 //
 // eta -> x
@@ -18,7 +20,12 @@
 // TODO: make sure we're doing things as simply as possibly in terms
 // of evaluating derivatives recursively and with minimal work
 
-void F3_compute(dbl eta, F3_context *context) {
+/**
+ * Compute F3 and its derivative at eta. If `want_hess` is true, also
+ * compute its second derivative, which requires the Hessian of the
+ * slowness.
+ */
+static void compute(dbl eta, F3_context *context, bool want_hess) {
   dbl T = cubic_f(&context->T_cubic, eta);
   dbl T_eta = cubic_df(&context->T_cubic, eta);
 
@@ -31,9 +38,34 @@ void F3_compute(dbl eta, F3_context *context) {
   dbl L_eta = -dvec2_dot(lp, dxy);
 
   dbl s0 = field2_f(context->slow, xyeta);
-  dbl s1 = field2_f(context->slow, context->xy);
+  dbl s1 = context->s;
   dbl s0_eta = dvec2_dot(field2_grad_f(context->slow, xyeta), dxy);
 
   context->F3 = T + (s0 + s1)*L/2;
   context->F3_eta = T_eta + (s0_eta*L + (s0 + s1)*L_eta)/2;
+
+  if (!want_hess) {
+    return;
+  }
+
+  dbl T_eta_eta = cubic_d2f(&context->T_cubic, eta);
+  dbl L_eta_eta = (dvec2_norm_sq(dxy) - L_eta*L_eta)/L;
+  dmat22 Hseta = field2_hess_f(context->slow, xyeta);
+  dbl s0_eta_eta = dvec2_dot(dmat22_dvec2_mul(Hseta, dxy), dxy);
+
+  context->F3_eta_eta = T_eta_eta
+    + (s0_eta_eta*L + 2*s0_eta*L_eta + (s0 + s1)*L_eta_eta)/2;
+}
+
+void F3_compute(dbl eta, F3_context *context) {
+  compute(eta, context, false);
+}
+
+/**
+ * Like `F3_compute`, but also compute `F3_eta_eta`. The slowness
+ * must have a Hessian (see `field2_has_hess`).
+ */
+void F3_compute_hess(dbl eta, F3_context *context) {
+  assert(field2_has_hess(context->slow));
+  compute(eta, context, true);
 }
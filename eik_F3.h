@@ -23,13 +23,18 @@ typedef struct {
   cubic_s T_cubic;
   dvec2 xy, xy0, xy1;
   field2_s const *slow;
+  dbl s; // The slowness at `xy`
 
   // Outputs:
   dbl F3;
   dbl F3_eta;
+
+  // Outputs (only set by F3_compute_hess):
+  dbl F3_eta_eta;
 } F3_context;
 
 void F3_compute(dbl eta, F3_context *context);
+void F3_compute_hess(dbl eta, F3_context *context);
 
 #ifdef __cplusplus
 }
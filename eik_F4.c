@@ -5,6 +5,12 @@
 
 #include "math.h"
 
+/**
+ * The number of step sizes tried at once by the line search in
+ * `step` after the full step is rejected.
+ */
+#define LS_BATCH 4
+
 // TODO: change naming conventions to make this take up less space:
 //
 // eta -> x
@@ -23,158 +29,359 @@
 // TODO: make sure we're doing things as simply as possibly in terms
 // of evaluating derivatives recursively and with minimal work
 
-void F4_compute(dbl eta, dbl th, F4_context *context) {
-  dbl T = cubic_f(&context->T_cubic, eta);
-  dbl T_eta = cubic_df(&context->T_cubic, eta);
-  // dbl T_eta_eta = cubic_d2f(&context->T_cubic, eta);
+/**
+ * The quantities computed while evaluating F4 and its gradient at a
+ * point (eta, th). Evaluating F4 is split into the part before the
+ * slowness is evaluated (`compute_geom`) and the part after it
+ * (`compute_grad`), so that `F4_compute_batch` can evaluate the
+ * slowness at each of its points at once.
+ */
+typedef struct point {
+  dbl T, T_eta;
+  dvec2 t0, t0_eta, t0_eta_unproj;
+  dbl gradTnorm;
+  dvec2 t1, t1_th, t1_minus_t0;
+  dvec2 dxy, xyeta;
+  dvec2 lp, lp_eta;
+  dbl L, L_eta;
+  dvec2 xym, xym_eta, xym_th;
+  dvec2 tm, tm_eta, tm_th;
+  dbl tmnorm, tmnorm_eta, tmnorm_th;
+
+  // Set before calling `compute_grad`:
+  dbl s0, s1, sm;
+  dvec2 gseta, gsm;
+
+  // Set by `compute_grad`:
+  dbl sm_eta, sm_th;
+  dbl S, S_eta, S_th;
+  dbl F4, F4_eta, F4_th;
+} point_s;
+
+static void compute_geom(dbl eta, dbl th, F4_context const *context,
+                         point_s *p) {
+  p->T = cubic_f(&context->T_cubic, eta);
+  p->T_eta = cubic_df(&context->T_cubic, eta);
 
   // t0 is normalized by definition
-  dvec2 t0 = {
+  p->t0 = (dvec2) {
     .x = cubic_f(&context->Tx_cubic, eta),
     .y = cubic_f(&context->Ty_cubic, eta)
   };
-  dbl gradTnorm = dvec2_norm(t0);
-  t0 = dvec2_dbl_div(t0, gradTnorm);
+  p->gradTnorm = dvec2_norm(p->t0);
+  p->t0 = dvec2_dbl_div(p->t0, p->gradTnorm);
 
-  dvec2 t0_eta = {
+  p->t0_eta = (dvec2) {
     .x = cubic_df(&context->Tx_cubic, eta),
     .y = cubic_df(&context->Ty_cubic, eta)
   };
-  t0_eta = dvec2_cproj(t0, dvec2_dbl_div(t0_eta, gradTnorm));
+  p->t0_eta = dvec2_dbl_div(p->t0_eta, p->gradTnorm);
+  p->t0_eta_unproj = p->t0_eta;
+  p->t0_eta = dvec2_cproj(p->t0, p->t0_eta);
 
   // t1 is normalized by definition
-  dvec2 t1 = {.x = cos(th), .y = sin(th)};
+  p->t1 = (dvec2) {.x = cos(th), .y = sin(th)};
 
   // avoid recomputing sin and cos of th
-  dvec2 t1_th = {.x = -t1.y, .y = t1.x};
+  p->t1_th = (dvec2) {.x = -p->t1.y, .y = p->t1.x};
 
-  dvec2 dxy = dvec2_sub(context->xy1, context->xy0);
-  dvec2 xyeta = dvec2_saxpy(eta, dxy, context->xy0);
+  p->dxy = dvec2_sub(context->xy1, context->xy0);
+  p->xyeta = dvec2_saxpy(eta, p->dxy, context->xy0);
 
-  dvec2 lp = dvec2_sub(context->xy, xyeta);
-  dbl L = dvec2_norm(lp);
-  lp = dvec2_dbl_div(lp, L);
-  dbl L_eta = -dvec2_dot(lp, dxy);
-  // dbl L_eta_eta = (dvec2_norm_sq(dxy) - L_eta*L_eta)/L;
+  p->lp = dvec2_sub(context->xy, p->xyeta);
+  p->L = dvec2_norm(p->lp);
+  p->lp = dvec2_dbl_div(p->lp, p->L);
+  p->L_eta = -dvec2_dot(p->lp, p->dxy);
 
-  dvec2 t1_minus_t0 = dvec2_sub(t1, t0);
+  p->t1_minus_t0 = dvec2_sub(p->t1, p->t0);
 
-  dvec2 xym = dvec2_sub(
-    dvec2_dbl_div(dvec2_add(context->xy, xyeta), 2),
-    dvec2_dbl_mul(t1_minus_t0, L/8)
+  p->xym = dvec2_sub(
+    dvec2_dbl_div(dvec2_add(context->xy, p->xyeta), 2),
+    dvec2_dbl_mul(p->t1_minus_t0, p->L/8)
   );
 
-  dbl s0 = field2_f(context->slow, xyeta);
-  dbl s1 = field2_f(context->slow, context->xy);
-  dbl sm = field2_f(context->slow, xym);
-
   // tm is unnormalized by definition, but its norm will be close to 1
   // because of the quasiuniform parametrization
-  dvec2 tm = dvec2_sub(
-    dvec2_dbl_mul(lp, 1.5),
-    dvec2_dbl_mul(dvec2_add(t0, t1), 0.25)
+  p->tm = dvec2_sub(
+    dvec2_dbl_mul(p->lp, 1.5),
+    dvec2_dbl_mul(dvec2_add(p->t0, p->t1), 0.25)
   );
-  dbl tmnorm = dvec2_norm(tm);
+  p->tmnorm = dvec2_norm(p->tm);
 
-  dvec2 lp_eta = dvec2_cproj(lp, dvec2_dbl_div(dxy, -L));
+  p->lp_eta = dvec2_cproj(p->lp, dvec2_dbl_div(p->dxy, -p->L));
 
-  dvec2 tm_eta = dvec2_sub(
-    dvec2_dbl_mul(lp_eta, 1.5),
-    dvec2_dbl_mul(t0_eta, 0.25)
+  p->tm_eta = dvec2_sub(
+    dvec2_dbl_mul(p->lp_eta, 1.5),
+    dvec2_dbl_mul(p->t0_eta, 0.25)
   );
-  dvec2 tm_th = dvec2_dbl_mul(t1_th, -0.25);
+  p->tm_th = dvec2_dbl_mul(p->t1_th, -0.25);
 
-  dbl tmnorm_eta = dvec2_dot(tm, tm_eta)/tmnorm;
-  dbl tmnorm_th = dvec2_dot(tm, tm_th)/tmnorm;
+  p->tmnorm_eta = dvec2_dot(p->tm, p->tm_eta)/p->tmnorm;
+  p->tmnorm_th = dvec2_dot(p->tm, p->tm_th)/p->tmnorm;
 
-  dvec2 xym_eta = dvec2_add(
-    dvec2_dbl_div(dxy, 2),
+  p->xym_eta = dvec2_add(
+    dvec2_dbl_div(p->dxy, 2),
     dvec2_dbl_div(
       dvec2_sub(
-        dvec2_dbl_mul(t0_eta, L),
-        dvec2_dbl_mul(t1_minus_t0, L_eta)
+        dvec2_dbl_mul(p->t0_eta, p->L),
+        dvec2_dbl_mul(p->t1_minus_t0, p->L_eta)
       ),
       8
     )
   );
-  dvec2 xym_th = dvec2_dbl_mul(t1_th, -L/8);
-
-  dvec2 gseta = field2_grad_f(context->slow, xyeta);
-  dvec2 gsm = field2_grad_f(context->slow, xym);
-
-  // dmat22 Hsm = field2_hess_f(context->slow, xym);
-
-  dbl s0_eta = dvec2_dot(gseta, dxy);
-
-  dbl sm_eta = dvec2_dot(gsm, xym_eta);
-  dbl sm_th = dvec2_dot(gsm, xym_th);
-  // dbl sm_eta_eta = dvec2_dot(dmat22_dvec2_mul(Hsm, xym_eta), xym_eta)
-  //   + dvec2_dot(gsm, xm_eta_eta);
-
-  dbl S = (s0 + s1 + 4*sm*tmnorm)/6;
-  dbl S_eta = (s0_eta + 4*(sm_eta*tmnorm + sm*tmnorm_eta))/6;
-  dbl S_th = 2*(sm_th*tmnorm + sm*tmnorm_th)/3;
-  // dbl S_eta_eta = (
-  //   s0_eta_eta
-  //   + 4*(sm_eta_eta*tmnorm + 2*sm_eta*tmnorm_eta + sm*tmnorm_eta_eta))/6;
-  // dbl S_eta_th = 2*(
-  //   sm_eta_th*tmnorm + sm_th*tmnorm_eta +
-  //   sm_eta*tmnorm_th + sm*tmnorm_eta_th)/3;
-  // dbl S_th_th = 2*(sm_th_th*tmnorm + 2*sm_th*tmnorm_th + sm*tmnorm_th)/3;
-
-  context->F4 = T + L*S;
-  context->F4_eta = T_eta + L*S_eta + S*L_eta;
-  context->F4_th = L*S_th;
-  // context->F4_eta_eta = T_eta_eta + L_eta_eta*S + 2*L_eta*S_eta + L*S_eta_eta;
-  // context->F4_eta_th = L_eta*S_th + L*S_eta_th;
-  // context->F4_th_th = L*S_th_th;
+  p->xym_th = dvec2_dbl_mul(p->t1_th, -p->L/8);
+}
+
+static void compute_grad(point_s *p) {
+  dbl s0_eta = dvec2_dot(p->gseta, p->dxy);
+
+  p->sm_eta = dvec2_dot(p->gsm, p->xym_eta);
+  p->sm_th = dvec2_dot(p->gsm, p->xym_th);
+
+  p->S = (p->s0 + p->s1 + 4*p->sm*p->tmnorm)/6;
+  p->S_eta = (s0_eta + 4*(p->sm_eta*p->tmnorm + p->sm*p->tmnorm_eta))/6;
+  p->S_th = 2*(p->sm_th*p->tmnorm + p->sm*p->tmnorm_th)/3;
+
+  p->F4 = p->T + p->L*p->S;
+  p->F4_eta = p->T_eta + p->L*p->S_eta + p->S*p->L_eta;
+  p->F4_th = p->L*p->S_th;
+}
+
+/**
+ * Compute F4 and its gradient at (eta, th). If `want_hess` is true,
+ * also compute its Hessian, which requires the Hessian of the
+ * slowness. Writing `q` for `tmnorm`, the second derivatives follow
+ * from applying the product and chain rules to:
+ *
+ *   F4 = T + L*S,  S = (s0 + s1 + 4*sm*q)/6.
+ */
+static void compute(dbl eta, dbl th, F4_context *context, bool want_hess) {
+  point_s p;
+  compute_geom(eta, th, context, &p);
+
+  p.s0 = field2_f(context->slow, p.xyeta);
+  p.s1 = context->s;
+  p.sm = field2_f(context->slow, p.xym);
+  p.gseta = field2_grad_f(context->slow, p.xyeta);
+  p.gsm = field2_grad_f(context->slow, p.xym);
+
+  compute_grad(&p);
+
+  context->F4 = p.F4;
+  context->F4_eta = p.F4_eta;
+  context->F4_th = p.F4_th;
+
+  if (!want_hess) {
+    return;
+  }
+
+  dbl T_eta_eta = cubic_d2f(&context->T_cubic, eta);
+
+  // Differentiate t0_eta = P*g'/|g|, where g = (Tx, Ty) and P is
+  // the projection onto the complement of t0
+  dvec2 t0_eta_eta = {
+    .x = cubic_d2f(&context->Tx_cubic, eta),
+    .y = cubic_d2f(&context->Ty_cubic, eta)
+  };
+  t0_eta_eta = dvec2_cproj(p.t0, dvec2_dbl_div(t0_eta_eta, p.gradTnorm));
+  t0_eta_eta = dvec2_sub(
+    t0_eta_eta,
+    dvec2_add(
+      dvec2_dbl_mul(p.t0_eta, 2*dvec2_dot(p.t0, p.t0_eta_unproj)),
+      dvec2_dbl_mul(p.t0, dvec2_norm_sq(p.t0_eta))
+    )
+  );
+
+  dbl L_eta_eta = (dvec2_norm_sq(p.dxy) - p.L_eta*p.L_eta)/p.L;
+
+  // Same as above, with g = xy - xyeta (so that g'' = 0)
+  dvec2 lp_eta_eta = dvec2_add(
+    dvec2_dbl_mul(p.lp_eta, -2*p.L_eta/p.L),
+    dvec2_dbl_mul(p.lp, -dvec2_norm_sq(p.lp_eta))
+  );
+
+  dvec2 tm_eta_eta = dvec2_sub(
+    dvec2_dbl_mul(lp_eta_eta, 1.5),
+    dvec2_dbl_mul(t0_eta_eta, 0.25)
+  );
+  dvec2 tm_th_th = dvec2_dbl_mul(p.t1, 0.25);
+
+  dbl tmnorm_eta_eta = (
+    dvec2_norm_sq(p.tm_eta) + dvec2_dot(p.tm, tm_eta_eta)
+    - p.tmnorm_eta*p.tmnorm_eta)/p.tmnorm;
+  dbl tmnorm_eta_th = (
+    dvec2_dot(p.tm_eta, p.tm_th) - p.tmnorm_eta*p.tmnorm_th)/p.tmnorm;
+  dbl tmnorm_th_th = (
+    dvec2_norm_sq(p.tm_th) + dvec2_dot(p.tm, tm_th_th)
+    - p.tmnorm_th*p.tmnorm_th)/p.tmnorm;
+
+  dvec2 xym_eta_eta = dvec2_dbl_div(
+    dvec2_add(
+      dvec2_add(
+        dvec2_dbl_mul(t0_eta_eta, p.L),
+        dvec2_dbl_mul(p.t0_eta, 2*p.L_eta)
+      ),
+      dvec2_dbl_mul(p.t1_minus_t0, -L_eta_eta)
+    ),
+    8
+  );
+  dvec2 xym_eta_th = dvec2_dbl_mul(p.t1_th, -p.L_eta/8);
+  dvec2 xym_th_th = dvec2_dbl_mul(p.t1, p.L/8);
+
+  dmat22 Hseta = field2_hess_f(context->slow, p.xyeta);
+  dmat22 Hsm = field2_hess_f(context->slow, p.xym);
+
+  dbl s0_eta_eta = dvec2_dot(dmat22_dvec2_mul(Hseta, p.dxy), p.dxy);
+
+  dvec2 Hsm_xym_eta = dmat22_dvec2_mul(Hsm, p.xym_eta);
+  dbl sm_eta_eta = dvec2_dot(Hsm_xym_eta, p.xym_eta)
+    + dvec2_dot(p.gsm, xym_eta_eta);
+  dbl sm_eta_th = dvec2_dot(Hsm_xym_eta, p.xym_th)
+    + dvec2_dot(p.gsm, xym_eta_th);
+  dbl sm_th_th = dvec2_dot(dmat22_dvec2_mul(Hsm, p.xym_th), p.xym_th)
+    + dvec2_dot(p.gsm, xym_th_th);
+
+  dbl S_eta_eta = (
+    s0_eta_eta
+    + 4*(sm_eta_eta*p.tmnorm + 2*p.sm_eta*p.tmnorm_eta
+         + p.sm*tmnorm_eta_eta))/6;
+  dbl S_eta_th = 2*(
+    sm_eta_th*p.tmnorm + p.sm_th*p.tmnorm_eta +
+    p.sm_eta*p.tmnorm_th + p.sm*tmnorm_eta_th)/3;
+  dbl S_th_th = 2*(
+    sm_th_th*p.tmnorm + 2*p.sm_th*p.tmnorm_th + p.sm*tmnorm_th_th)/3;
+
+  context->F4_eta_eta =
+    T_eta_eta + L_eta_eta*p.S + 2*p.L_eta*p.S_eta + p.L*S_eta_eta;
+  context->F4_eta_th = p.L_eta*p.S_th + p.L*S_eta_th;
+  context->F4_th_th = p.L*S_th_th;
+}
+
+void F4_compute(dbl eta, dbl th, F4_context *context) {
+  compute(eta, th, context, false);
+}
+
+/**
+ * Like `F4_compute`, but also compute the Hessian of F4 (see
+ * `F4_get_hess`). The slowness must have a Hessian (see
+ * `field2_has_hess`).
+ */
+void F4_compute_hess(dbl eta, dbl th, F4_context *context) {
+  assert(field2_has_hess(context->slow));
+  compute(eta, th, context, true);
+}
+
+/**
+ * Compute F4 and its gradient at each of the `n` points (eta[i],
+ * th[i]), writing them to `F4[i]` and `grad[i]`. The results are the
+ * same as calling `F4_compute` at each point, but the slowness and
+ * its gradient are each evaluated with one call for the whole batch
+ * (see `field2_f_batch`). Unlike `F4_compute`, this doesn't change
+ * the outputs stored in `context`. At most F4_MAX_BATCH points can
+ * be computed at once.
+ */
+void F4_compute_batch(int n, dbl const *eta, dbl const *th,
+                      F4_context const *context, dbl *F4, dvec2 *grad) {
+  assert(0 <= n && n <= F4_MAX_BATCH);
+
+  point_s p[F4_MAX_BATCH];
+  for (int i = 0; i < n; ++i) {
+    compute_geom(eta[i], th[i], context, &p[i]);
+  }
+
+  // Evaluate s and its gradient at xyeta and xym for each point
+  dvec2 xy[2*F4_MAX_BATCH] = {0};
+  for (int i = 0; i < n; ++i) {
+    xy[2*i] = p[i].xyeta;
+    xy[2*i + 1] = p[i].xym;
+  }
+
+  dbl s[2*F4_MAX_BATCH];
+  dvec2 grad_s[2*F4_MAX_BATCH];
+  field2_f_batch(context->slow, 2*n, xy, s);
+  field2_grad_f_batch(context->slow, 2*n, xy, grad_s);
+
+  for (int i = 0; i < n; ++i) {
+    p[i].s0 = s[2*i];
+    p[i].s1 = context->s;
+    p[i].sm = s[2*i + 1];
+    p[i].gseta = grad_s[2*i];
+    p[i].gsm = grad_s[2*i + 1];
+    compute_grad(&p[i]);
+    F4[i] = p[i].F4;
+    grad[i] = (dvec2) {p[i].F4_eta, p[i].F4_th};
+  }
 }
 
 dvec2 F4_get_grad(F4_context const *context) {
   return (dvec2) {context->F4_eta, context->F4_th};
 }
 
-dmat22 F4_hess_fd(dbl eta, dbl th, dbl eps, F4_context *context) {
-  dmat22 hess;
-
-  F4_compute(eta + eps, th, context);
-  hess.rows[0] = F4_get_grad(context);
-  F4_compute(eta - eps, th, context);
-  hess.rows[0] = dvec2_sub(hess.rows[0], F4_get_grad(context));
-  hess.rows[0] = dvec2_dbl_div(hess.rows[0], 2*eps);
+dmat22 F4_get_hess(F4_context const *context) {
+  dmat22 hess = {
+    .data = {
+      {context->F4_eta_eta, context->F4_eta_th},
+      {context->F4_eta_th, context->F4_th_th}
+    }
+  };
+  return hess;
+}
 
-  F4_compute(eta, th + eps, context);
-  hess.rows[1] = F4_get_grad(context);
-  F4_compute(eta, th - eps, context);
-  hess.rows[1] = dvec2_sub(hess.rows[1], F4_get_grad(context));
-  hess.rows[1] = dvec2_dbl_div(hess.rows[1], 2*eps);
+/**
+ * Approximate the Hessian of F4 at (eta, th) using centered
+ * differences of its gradient with step size `eps`. The four
+ * gradients are computed using one call to `F4_compute_batch`.
+ */
+dmat22 F4_hess_fd(dbl eta, dbl th, dbl eps, F4_context const *context) {
+  dbl const eta_fd[4] = {eta + eps, eta - eps, eta, eta};
+  dbl const th_fd[4] = {th, th, th + eps, th - eps};
+  dbl F4[4];
+  dvec2 grad[4];
+  F4_compute_batch(4, eta_fd, th_fd, context, F4, grad);
 
+  dmat22 hess;
+  hess.rows[0] = dvec2_dbl_div(dvec2_sub(grad[0], grad[1]), 2*eps);
+  hess.rows[1] = dvec2_dbl_div(dvec2_sub(grad[2], grad[3]), 2*eps);
   return hess;
 }
 
+/**
+ * If the Hessian `H` is indefinite, we want to perturb it by a
+ * constant multiple times the identity so that it it's positive
+ * definite. We assume that the hessian can't be negative definite
+ * (hopefully this can't happen... something really weird would have
+ * had to have happened. Then, invert it.
+ */
+static void make_pd_and_invert(dmat22 *H) {
+  dbl lam1, lam2;
+  dmat22_eigvals(H, &lam1, &lam2);
+  assert(lam1 > 0);
+  if (lam2 < 0) {
+    H->data[0][0] -= 2*lam2;
+    H->data[1][1] -= 2*lam2;
+  }
+  dmat22_invert(H);
+}
+
+/**
+ * Initialize the minimization of F4 at (eta, th). The initial inverse
+ * Hessian `H0` is exact if the slowness has a Hessian, in which case
+ * this only evaluates F4 once. Otherwise, it's approximated using
+ * finite differences.
+ */
 void F4_bfgs_init(dbl eta, dbl th, dvec2 *x0, dvec2 *g0, dmat22 *H0,
                   F4_context *context) {
   *x0 = (dvec2) {.x = eta, .y = th};
-  F4_compute(x0->x, x0->y, context);
-  *g0 = F4_get_grad(context);
-  *H0 = F4_hess_fd(eta, th, 1e-7, context);
-  /**
-   * If the hessian is indefinite, we want to perturb it by a constant
-   * multiple times the identity so that it it's positive definite. We
-   * assume that the hessian can't be negative definite (hopefully
-   * this can't happen... something really weird would have had to
-   * have happened.
-   */
-  {
-    dbl lam1, lam2;
-    dmat22_eigvals(H0, &lam1, &lam2);
-    assert(lam1 > 0);
-    if (lam2 < 0) {
-      H0->data[0][0] -= 2*lam2;
-      H0->data[1][1] -= 2*lam2;
-    }
+  if (field2_has_hess(context->slow)) {
+    F4_compute_hess(x0->x, x0->y, context);
+    *g0 = F4_get_grad(context);
+    *H0 = F4_get_hess(context);
+  } else {
+    F4_compute(x0->x, x0->y, context);
+    *g0 = F4_get_grad(context);
+    *H0 = F4_hess_fd(eta, th, 1e-7, context);
   }
-  dmat22_invert(H0);
+  make_pd_and_invert(H0);
 }
 
 static void update_dfp(dvec2 xk1, dvec2 xk, dvec2 gk1, dvec2 gk, dmat22 Hk,
@@ -214,17 +421,31 @@ static void update_dfp(dvec2 xk1, dvec2 xk, dvec2 gk1, dvec2 gk, dmat22 Hk,
 //   *Hk1 = dmat22_add(*Hk1, tmp);
 // }
 
-bool F4_bfgs_step(dvec2 xk, dvec2 gk, dmat22 Hk,
-                  dvec2 *xk1, dvec2 *gk1, dmat22 *Hk1,
-                  F4_context *context) {
+/**
+ * Take one step of the minimization of F4 from `xk`, where `gk` is
+ * the gradient and `Hk` is the inverse Hessian (or an approximation
+ * of it) at `xk`. If `newton` is true, the inverse Hessian at `xk1`
+ * is computed exactly; otherwise, it's approximated using a DFP
+ * update.
+ */
+static bool step(dvec2 xk, dvec2 gk, dmat22 Hk,
+                 dvec2 *xk1, dvec2 *gk1, dmat22 *Hk1,
+                 F4_context *context, bool newton) {
   dvec2 pk = dmat22_dvec2_mul(Hk, gk);
   dvec2_negate(&pk);
 
-  // Verify that pk is a descent direction.
+  // Stop if pk isn't a descent direction. This happens if the
+  // gradient vanishes (`xk` is already a minimizer), or if Hk isn't
+  // positive definite (e.g., when the cubics along the edge were
+  // built from jets which are still far off while sweeping).
   dbl pk_dot_gk = dvec2_dot(pk, gk);
-  assert(pk_dot_gk < 0);
+  if (!(pk_dot_gk < 0)) {
+    return false;
+  }
 
-  // Scale the step so that 0 <= eta <= 1.
+  // Scale the step so that 0 <= eta <= 1. If the step ends on the
+  // boundary, roundoff can leave eta just past it, so it's clamped
+  // below, too.
   dbl t = pk.x > 0. ? 1. : 0.;
   t -= xk.x;
   t /= pk.x;
@@ -238,36 +459,89 @@ bool F4_bfgs_step(dvec2 xk, dvec2 gk, dmat22 Hk,
     dbl const c1 = 1e-4;
     dbl const rho = 0.9;
 
-    dbl fk = context->F4, fk1;
-    while (true) {
-      *xk1 = dvec2_add(xk, dvec2_dbl_mul(pk, t));
-      F4_compute(xk1->x, xk1->y, context);
-      fk1 = context->F4;
-      if (fk1 <= fk + c1*t*pk_dot_gk) {
-        break;
-      } else {
+    dbl fk = context->F4;
+    *xk1 = dvec2_add(xk, dvec2_dbl_mul(pk, t));
+    xk1->x = clamp(xk1->x, 0, 1);
+    compute(xk1->x, xk1->y, context, newton);
+    while (!(context->F4 <= fk + c1*t*pk_dot_gk)) {
+      if (newton) {
         t *= rho;
+        *xk1 = dvec2_add(xk, dvec2_dbl_mul(pk, t));
+        compute(xk1->x, xk1->y, context, newton);
+        continue;
       }
+
+      // The full step is almost always accepted, but once it isn't,
+      // it usually takes several more steps to satisfy the sufficient
+      // decrease condition. So, try the next few step sizes at once.
+      dbl t_ls[LS_BATCH], eta[LS_BATCH], th[LS_BATCH], F4[LS_BATCH];
+      dvec2 grad[LS_BATCH];
+      for (int i = 0; i < LS_BATCH; ++i) {
+        t *= rho;
+        t_ls[i] = t;
+        dvec2 xy = dvec2_add(xk, dvec2_dbl_mul(pk, t));
+        eta[i] = xy.x;
+        th[i] = xy.y;
+      }
+      F4_compute_batch(LS_BATCH, eta, th, context, F4, grad);
+
+      int i = 0;
+      while (i < LS_BATCH - 1 && !(F4[i] <= fk + c1*t_ls[i]*pk_dot_gk)) {
+        ++i;
+      }
+      t = t_ls[i];
+      *xk1 = (dvec2) {.x = eta[i], .y = th[i]};
+      context->F4 = F4[i];
+      context->F4_eta = grad[i].x;
+      context->F4_th = grad[i].y;
     }
   } else {
     *xk1 = dvec2_add(xk, dvec2_dbl_mul(pk, t));
-    F4_compute(xk1->x, xk1->y, context);
+    xk1->x = clamp(xk1->x, 0, 1);
+    compute(xk1->x, xk1->y, context, newton);
   }
 
-  // Now, compute a new gradient and do the DFP update to update our
-  // approximation of the inverse Hessian.
+  // Now, compute a new gradient and either compute the new inverse
+  // Hessian or do the DFP update to update our approximation of it.
   *gk1 = F4_get_grad(context);
-  update_dfp(*xk1, xk, *gk1, gk, Hk, Hk1);
+  if (newton) {
+    *Hk1 = F4_get_hess(context);
+    make_pd_and_invert(Hk1);
+  } else {
+    update_dfp(*xk1, xk, *gk1, gk, Hk, Hk1);
+  }
 
   if (t < 1 && (fabs(xk1->x) < EPS || fabs(1 - xk1->x) < EPS)) {
     dbl F4_th_th = Hk1->data[0][0]/dmat22_det(Hk1);
     dbl F4_th = gk1->y;
     xk1->y -= F4_th/F4_th_th;
 
-    F4_compute(xk1->x, xk1->y, context);
+    compute(xk1->x, xk1->y, context, newton);
     *gk1 = F4_get_grad(context);
-    update_dfp(*xk1, xk, *gk1, gk, Hk, Hk1);
+    if (newton) {
+      *Hk1 = F4_get_hess(context);
+      make_pd_and_invert(Hk1);
+    } else {
+      update_dfp(*xk1, xk, *gk1, gk, Hk, Hk1);
+    }
   }
 
   return true;
 }
+
+bool F4_bfgs_step(dvec2 xk, dvec2 gk, dmat22 Hk,
+                  dvec2 *xk1, dvec2 *gk1, dmat22 *Hk1,
+                  F4_context *context) {
+  return step(xk, gk, Hk, xk1, gk1, Hk1, context, false);
+}
+
+/**
+ * Like `F4_bfgs_step`, but take a Newton step using the exact
+ * Hessian of F4. The slowness must have a Hessian.
+ */
+bool F4_newton_step(dvec2 xk, dvec2 gk, dmat22 Hk,
+                    dvec2 *xk1, dvec2 *gk1, dmat22 *Hk1,
+                    F4_context *context) {
+  assert(field2_has_hess(context->slow));
+  return step(xk, gk, Hk, xk1, gk1, Hk1, context, true);
+}
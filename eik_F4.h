@@ -26,21 +26,40 @@ typedef struct {
   cubic_s T_cubic, Tx_cubic, Ty_cubic;
   dvec2 xy, xy0, xy1;
   field2_s const *slow;
+  dbl s; // The slowness at `xy`
 
   // Outputs:
   dbl F4;
   dbl F4_eta;
   dbl F4_th;
+
+  // Outputs (only set by F4_compute_hess):
+  dbl F4_eta_eta;
+  dbl F4_eta_th;
+  dbl F4_th_th;
 } F4_context;
 
+/**
+ * The maximum number of points `F4_compute_batch` can compute at
+ * once.
+ */
+#define F4_MAX_BATCH 8
+
 void F4_compute(dbl eta, dbl th, F4_context *context);
+void F4_compute_hess(dbl eta, dbl th, F4_context *context);
+void F4_compute_batch(int n, dbl const *eta, dbl const *th,
+                      F4_context const *context, dbl *F4, dvec2 *grad);
 dvec2 F4_get_grad(F4_context const *context);
-dmat22 F4_hess_fd(dbl eta, dbl th, dbl eps, F4_context *context);
+dmat22 F4_get_hess(F4_context const *context);
+dmat22 F4_hess_fd(dbl eta, dbl th, dbl eps, F4_context const *context);
 void F4_bfgs_init(dbl eta, dbl th, dvec2 *x0, dvec2 *g0, dmat22 *H0,
                   F4_context *context);
 bool F4_bfgs_step(dvec2 xk, dvec2 gk, dmat22 Hk,
                   dvec2 *xk1, dvec2 *gk1, dmat22 *Hk1,
                   F4_context *context);
+bool F4_newton_step(dvec2 xk, dvec2 gk, dmat22 Hk,
+                    dvec2 *xk1, dvec2 *gk1, dmat22 *Hk1,
+                    F4_context *context);
 
 #ifdef __cplusplus
 }
@@ -1,6 +1,13 @@
 #include "eik_S4.h"
 
-void S4_compute(dbl th, S4_context *context) {
+#include <assert.h>
+
+/**
+ * Compute S4 and its derivative at th. If `want_hess` is true, also
+ * compute its second derivative, which requires the Hessian of the
+ * slowness.
+ */
+static void compute(dbl th, S4_context *context, bool want_hess) {
   dvec2 t = {.x = cos(th), .y = sin(th)};
   dvec2 t_th = {.x = -t.y, .y = t.x};
 
@@ -27,4 +34,34 @@ void S4_compute(dbl th, S4_context *context) {
 
   context->S4 = (context->s + 4*sm*tmnorm + context->s0)/6;
   context->S4_th = 2*(sm_th*tmnorm + sm*tmnorm_th)/3;
+
+  if (!want_hess) {
+    return;
+  }
+
+  dvec2 xym_th_th = dvec2_dbl_mul(t, context->L/8);
+  dmat22 Hsm = field2_hess_f(context->slow, xym);
+  dbl sm_th_th = dvec2_dot(dmat22_dvec2_mul(Hsm, xym_th), xym_th)
+    + dvec2_dot(gsm, xym_th_th);
+
+  dvec2 tm_th_th = dvec2_dbl_mul(t, 0.25);
+  dbl tmnorm_th_th = (
+    dvec2_norm_sq(tm_th) + dvec2_dot(tm, tm_th_th)
+    - tmnorm_th*tmnorm_th)/tmnorm;
+
+  context->S4_th_th = 2*(
+    sm_th_th*tmnorm + 2*sm_th*tmnorm_th + sm*tmnorm_th_th)/3;
+}
+
+void S4_compute(dbl th, S4_context *context) {
+  compute(th, context, false);
+}
+
+/**
+ * Like `S4_compute`, but also compute `S4_th_th`. The slowness must
+ * have a Hessian (see `field2_has_hess`).
+ */
+void S4_compute_hess(dbl th, S4_context *context) {
+  assert(field2_has_hess(context->slow));
+  compute(th, context, true);
 }
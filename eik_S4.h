@@ -15,9 +15,11 @@ typedef struct {
   dvec2 t0;
   dbl S4_th;
   dbl S4;
+  dbl S4_th_th; // Only set by S4_compute_hess
 } S4_context;
 
 void S4_compute(dbl th, S4_context *context);
+void S4_compute_hess(dbl th, S4_context *context);
 
 #ifdef __cplusplus
 }
@@ -1,5 +1,11 @@
 #include "field.h"
 
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "bicubic.h"
+
 dbl field2_f(field2_s const *field, dvec2 xy) {
   return field->f(xy.x, xy.y, field->context);
 }
@@ -7,3 +13,314 @@ dbl field2_f(field2_s const *field, dvec2 xy) {
 dvec2 field2_grad_f(field2_s const *field, dvec2 xy) {
   return field->grad_f(xy.x, xy.y, field->context);
 }
+
+bool field2_has_hess(field2_s const *field) {
+  return field->hess_f != NULL;
+}
+
+dmat22 field2_hess_f(field2_s const *field, dvec2 xy) {
+  return field->hess_f(xy.x, xy.y, field->context);
+}
+
+/**
+ * Evaluate `field` at each of the `n` points `xy`, writing the
+ * values to `f`.
+ */
+void field2_f_batch(field2_s const *field, int n, dvec2 const *xy, dbl *f) {
+  if (field->f_batch != NULL) {
+    field->f_batch(n, xy, f, field->context);
+    return;
+  }
+  for (int i = 0; i < n; ++i) {
+    f[i] = field->f(xy[i].x, xy[i].y, field->context);
+  }
+}
+
+/**
+ * Evaluate the gradient of `field` at each of the `n` points `xy`,
+ * writing the gradients to `grad_f`.
+ */
+void field2_grad_f_batch(field2_s const *field, int n, dvec2 const *xy,
+                         dvec2 *grad_f) {
+  if (field->grad_f_batch != NULL) {
+    field->grad_f_batch(n, xy, grad_f, field->context);
+    return;
+  }
+  for (int i = 0; i < n; ++i) {
+    grad_f[i] = field->grad_f(xy[i].x, xy[i].y, field->context);
+  }
+}
+
+static dbl constant_f(dbl x, dbl y, void *context) {
+  (void)x;
+  (void)y;
+  return *(dbl const *)context;
+}
+
+static dvec2 constant_grad_f(dbl x, dbl y, void *context) {
+  (void)x;
+  (void)y;
+  (void)context;
+  return dvec2_zero();
+}
+
+static dmat22 constant_hess_f(dbl x, dbl y, void *context) {
+  (void)x;
+  (void)y;
+  (void)context;
+  dmat22 hess = {.data = {{0, 0}, {0, 0}}};
+  return hess;
+}
+
+static void constant_f_batch(int n, dvec2 const *xy, dbl *f, void *context) {
+  (void)xy;
+  dbl s = *(dbl const *)context;
+  for (int i = 0; i < n; ++i) {
+    f[i] = s;
+  }
+}
+
+static void constant_grad_f_batch(int n, dvec2 const *xy, dvec2 *grad_f,
+                                  void *context) {
+  (void)xy;
+  (void)context;
+  for (int i = 0; i < n; ++i) {
+    grad_f[i] = dvec2_zero();
+  }
+}
+
+/**
+ * Get a `field2_s` which is equal to `*s` everywhere. It refers to
+ * `s`, so `s` needs to outlive it.
+ */
+field2_s field2_constant(dbl const *s) {
+  field2_s field = {
+    .f = constant_f,
+    .grad_f = constant_grad_f,
+    .hess_f = constant_hess_f,
+    .context = (void *)s,
+    .f_batch = constant_f_batch,
+    .grad_f_batch = constant_grad_f_batch
+  };
+  return field;
+}
+
+static dbl linear_speed_f(dbl x, dbl y, void *context) {
+  dvec2 const *v = context;
+  return 1/(1 + v->x*x + v->y*y);
+}
+
+static dvec2 linear_speed_grad_f(dbl x, dbl y, void *context) {
+  dvec2 const *v = context;
+  dbl s = linear_speed_f(x, y, context);
+  return dvec2_dbl_mul(*v, -s*s);
+}
+
+static dmat22 linear_speed_hess_f(dbl x, dbl y, void *context) {
+  dvec2 const *v = context;
+  dbl s = linear_speed_f(x, y, context);
+  return dmat22_dbl_mul(dvec2_outer(*v, *v), 2*s*s*s);
+}
+
+static void linear_speed_f_batch(int n, dvec2 const *xy, dbl *f,
+                                 void *context) {
+  dvec2 const *v = context;
+  for (int i = 0; i < n; ++i) {
+    f[i] = 1/(1 + v->x*xy[i].x + v->y*xy[i].y);
+  }
+}
+
+static void linear_speed_grad_f_batch(int n, dvec2 const *xy, dvec2 *grad_f,
+                                      void *context) {
+  dvec2 const *v = context;
+  for (int i = 0; i < n; ++i) {
+    dbl s = 1/(1 + v->x*xy[i].x + v->y*xy[i].y);
+    grad_f[i].x = -s*s*v->x;
+    grad_f[i].y = -s*s*v->y;
+  }
+}
+
+/**
+ * Get a `field2_s` for the slowness s = 1/c of the linear speed
+ * function c(x, y) = 1 + v.x*x + v.y*y. It refers to `v`, so `v`
+ * needs to outlive it.
+ */
+field2_s field2_linear_speed(dvec2 const *v) {
+  field2_s field = {
+    .f = linear_speed_f,
+    .grad_f = linear_speed_grad_f,
+    .hess_f = linear_speed_hess_f,
+    .context = (void *)v,
+    .f_batch = linear_speed_f_batch,
+    .grad_f_batch = linear_speed_grad_f_batch
+  };
+  return field;
+}
+
+/**
+ * The values passed to `field2_tab_init` are stored in row-major
+ * order, so that `values[shape.j*i + j]` is the value at (i, j). The
+ * bicubics are stored in the same way.
+ */
+struct field2_tab {
+  ivec2 shape;
+  dvec2 xymin;
+  dbl h;
+  bicubic_s *bicubics;
+};
+
+void field2_tab_alloc(field2_tab_s **tab) {
+  *tab = malloc(sizeof(field2_tab_s));
+  assert(*tab != NULL);
+}
+
+void field2_tab_dealloc(field2_tab_s **tab) {
+  free(*tab);
+  *tab = NULL;
+}
+
+/**
+ * Estimate the derivative of `f[0], f[stride], ..., f[(n - 1)*stride]`
+ * (sampled with spacing `h`) using second-order finite differences,
+ * storing the result in `df` in the same way.
+ */
+static void diff(dbl const *f, dbl *df, int n, int stride, dbl h) {
+  int s = stride, m = n - 1;
+  df[0] = (-3*f[0] + 4*f[s] - f[2*s])/(2*h);
+  for (int k = 1; k < m; ++k) {
+    df[k*s] = (f[(k + 1)*s] - f[(k - 1)*s])/(2*h);
+  }
+  df[m*s] = (3*f[m*s] - 4*f[(m - 1)*s] + f[(m - 2)*s])/(2*h);
+}
+
+void field2_tab_init(field2_tab_s *tab, ivec2 shape, dvec2 xymin, dbl h,
+                     dbl const *values) {
+  assert(shape.i >= 3 && shape.j >= 3);
+
+  tab->shape = shape;
+  tab->xymin = xymin;
+  tab->h = h;
+
+  int nnodes = shape.i*shape.j;
+  dbl *fx = malloc(nnodes*sizeof(dbl));
+  dbl *fy = malloc(nnodes*sizeof(dbl));
+  dbl *fxy = malloc(nnodes*sizeof(dbl));
+  assert(fx != NULL);
+  assert(fy != NULL);
+  assert(fxy != NULL);
+
+  for (int j = 0; j < shape.j; ++j) {
+    diff(&values[j], &fx[j], shape.i, shape.j, h);
+  }
+  for (int i = 0; i < shape.i; ++i) {
+    diff(&values[shape.j*i], &fy[shape.j*i], shape.j, 1, h);
+  }
+  for (int j = 0; j < shape.j; ++j) {
+    diff(&fy[j], &fxy[j], shape.i, shape.j, h);
+  }
+
+  tab->bicubics = malloc((shape.i - 1)*(shape.j - 1)*sizeof(bicubic_s));
+  assert(tab->bicubics != NULL);
+
+  dbl h_sq = h*h;
+  for (int i = 0; i < shape.i - 1; ++i) {
+    for (int j = 0; j < shape.j - 1; ++j) {
+      /* Linear indices of the cell's vertices (see `build_cell` in
+       * eik.c for the ordering) */
+      int l[4] = {
+        shape.j*i + j,
+        shape.j*(i + 1) + j,
+        shape.j*i + j + 1,
+        shape.j*(i + 1) + j + 1
+      };
+      dmat44 data;
+      for (int k = 0; k < 4; ++k) {
+        int a = k % 2, b = k/2;
+        data.data[a][b] = values[l[k]];
+        data.data[2 + a][b] = h*fx[l[k]];
+        data.data[a][2 + b] = h*fy[l[k]];
+        data.data[2 + a][2 + b] = h_sq*fxy[l[k]];
+      }
+      bicubic_set_data(&tab->bicubics[(shape.j - 1)*i + j], data);
+    }
+  }
+
+  free(fx);
+  free(fy);
+  free(fxy);
+}
+
+void field2_tab_deinit(field2_tab_s *tab) {
+  free(tab->bicubics);
+  tab->bicubics = NULL;
+}
+
+/**
+ * Get the bicubic for the cell containing `xy`, and the coordinates
+ * `cc` of `xy` in that cell. Points outside of the grid are clamped
+ * to it.
+ */
+static bicubic_s const *get_bicubic(field2_tab_s const *tab, dvec2 xy,
+                                    dvec2 *cc) {
+  *cc = dvec2_dbl_div(dvec2_sub(xy, tab->xymin), tab->h);
+  dvec2 ind_ = dvec2_floor(*cc);
+  ivec2 ind = dvec2_to_ivec2(ind_);
+  *cc = dvec2_sub(*cc, ind_);
+
+  if (ind.i < 0) {
+    ind.i = 0;
+    cc->x = 0.0;
+  } else if (ind.i >= tab->shape.i - 1) {
+    ind.i = tab->shape.i - 2;
+    cc->x = 1.0;
+  }
+
+  if (ind.j < 0) {
+    ind.j = 0;
+    cc->y = 0.0;
+  } else if (ind.j >= tab->shape.j - 1) {
+    ind.j = tab->shape.j - 2;
+    cc->y = 1.0;
+  }
+
+  return &tab->bicubics[(tab->shape.j - 1)*ind.i + ind.j];
+}
+
+static dbl tab_f(dbl x, dbl y, void *context) {
+  dvec2 cc;
+  bicubic_s const *bicubic = get_bicubic(context, (dvec2) {x, y}, &cc);
+  return bicubic_f(bicubic, cc);
+}
+
+static dvec2 tab_grad_f(dbl x, dbl y, void *context) {
+  field2_tab_s const *tab = context;
+  dvec2 cc;
+  bicubic_s const *bicubic = get_bicubic(tab, (dvec2) {x, y}, &cc);
+  dvec2 grad = {bicubic_fx(bicubic, cc), bicubic_fy(bicubic, cc)};
+  return dvec2_dbl_div(grad, tab->h);
+}
+
+static dmat22 tab_hess_f(dbl x, dbl y, void *context) {
+  field2_tab_s const *tab = context;
+  dvec2 cc;
+  bicubic_s const *bicubic = get_bicubic(tab, (dvec2) {x, y}, &cc);
+  dmat22 hess;
+  hess.data[0][0] = bicubic_fxx(bicubic, cc);
+  hess.data[0][1] = hess.data[1][0] = bicubic_fxy(bicubic, cc);
+  hess.data[1][1] = bicubic_fyy(bicubic, cc);
+  return dmat22_dbl_div(hess, tab->h*tab->h);
+}
+
+/**
+ * Get a `field2_s` which evaluates `tab`. It refers to `tab`, so it
+ * can't be used after `tab` is deinitialized.
+ */
+field2_s field2_tab_get_field2(field2_tab_s *tab) {
+  field2_s field = {
+    .f = tab_f,
+    .grad_f = tab_grad_f,
+    .hess_f = tab_hess_f,
+    .context = (void *)tab
+  };
+  return field;
+}
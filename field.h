@@ -4,16 +4,58 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+
+#include "mat.h"
 #include "vec.h"
 
+/**
+ * A scalar field on the plane, given by its value and gradient. The
+ * Hessian `hess_f` is optional and can be left NULL; if it's
+ * provided, it's used to compute exact Hessians when minimizing F4
+ * (see eik_F4.c).
+ *
+ * `f_batch` and `grad_f_batch` are optional, too. If provided, they
+ * evaluate `f` and `grad_f` at `n` points at once, which lets F4 be
+ * evaluated at several points with one call per batch of points
+ * (see `F4_compute_batch`). Otherwise, `f` and `grad_f` are called
+ * at each point.
+ */
 typedef struct field2 {
   dbl(*f)(dbl, dbl, void*);
   dvec2(*grad_f)(dbl, dbl, void*);
+  dmat22(*hess_f)(dbl, dbl, void*);
   void *context;
+  void(*f_batch)(int, dvec2 const *, dbl *, void*);
+  void(*grad_f_batch)(int, dvec2 const *, dvec2 *, void*);
 } field2_s;
 
 dbl field2_f(field2_s const *field, dvec2 xy);
 dvec2 field2_grad_f(field2_s const *field, dvec2 xy);
+bool field2_has_hess(field2_s const *field);
+dmat22 field2_hess_f(field2_s const *field, dvec2 xy);
+void field2_f_batch(field2_s const *field, int n, dvec2 const *xy, dbl *f);
+void field2_grad_f_batch(field2_s const *field, int n, dvec2 const *xy,
+                         dvec2 *grad_f);
+
+field2_s field2_constant(dbl const *s);
+field2_s field2_linear_speed(dvec2 const *v);
+
+/**
+ * A tabulated field: values sampled on a regular grid of shape
+ * `shape` with spacing `h` and lower-left corner `xymin` (like the
+ * grid of an `eik_s`), which are interpolated using bicubics. Use
+ * `field2_tab_get_field2` to get a `field2_s` which evaluates the
+ * interpolant.
+ */
+typedef struct field2_tab field2_tab_s;
+
+void field2_tab_alloc(field2_tab_s **tab);
+void field2_tab_dealloc(field2_tab_s **tab);
+void field2_tab_init(field2_tab_s *tab, ivec2 shape, dvec2 xymin, dbl h,
+                     dbl const *values);
+void field2_tab_deinit(field2_tab_s *tab);
+field2_s field2_tab_get_field2(field2_tab_s *tab);
 
 #ifdef __cplusplus
 }
@@ -4,13 +4,31 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "bucket.h"
+
+/**
+ * Each entry of the heap stores the index of the element along with
+ * a cached copy of its key. Keeping the keys inline means that
+ * sifting elements up and down the heap never has to leave the heap
+ * array: the `value` callback is only used to fetch the key when an
+ * element is inserted or when `heap_swim` is called. Callers that
+ * know the new key of an element should use `heap_update_key`
+ * instead, which avoids calling `value` altogether.
+ */
+typedef struct heap_elt {
+  dbl key;
+  int ind;
+} heap_elt_s;
+
 typedef struct heap {
   int capacity;
   int size;
-  int* inds;
+  int arity, log2_arity;
+  heap_elt_s *elts;
   value_f value;
   setpos_f setpos;
   void *context;
+  bucket_s *bucket;
 } heap_s;
 
 void heap_alloc(heap_s **heap) {
@@ -27,110 +45,182 @@ void heap_init(heap_s *heap, int capacity, value_f value, setpos_f setpos,
                void *context) {
   heap->capacity = capacity;
   heap->size = 0;
-  heap->inds = malloc(heap->capacity*sizeof(int));
-  assert(heap->inds != NULL);
+  heap->elts = malloc(heap->capacity*sizeof(heap_elt_s));
+  assert(heap->elts != NULL);
 #if SJS_DEBUG
   for (int i = 0; i < heap->capacity; ++i) {
-    heap->inds[i] = NO_INDEX;
+    heap->elts[i].key = NAN;
+    heap->elts[i].ind = NO_INDEX;
   }
 #endif
   heap->value = value;
   heap->setpos = setpos;
   heap->context = context;
+  heap->bucket = NULL;
+  heap_set_arity(heap, HEAP_ARITY);
 }
 
 void heap_deinit(heap_s *heap) {
-  free(heap->inds);
-  heap->inds = NULL;
+  free(heap->elts);
+  heap->elts = NULL;
+
+  if (heap->bucket != NULL) {
+    bucket_deinit(heap->bucket);
+    bucket_dealloc(&heap->bucket);
+  }
 }
 
 void heap_grow(heap_s *heap) {
   heap->capacity *= 2;
-  heap->inds = realloc(heap->inds, sizeof(int)*heap->capacity);
-  assert(heap->inds != NULL);
+  heap->elts = realloc(heap->elts, sizeof(heap_elt_s)*heap->capacity);
+  assert(heap->elts != NULL);
 #if SJS_DEBUG
   for (int i = heap->size; i < heap->capacity; ++i) {
-    heap->inds[i] = NO_INDEX;
+    heap->elts[i].key = NAN;
+    heap->elts[i].ind = NO_INDEX;
   }
 #endif
 }
 
-int left(int pos) {
-  return 2*pos + 1;
-}
-
-int right(int pos) {
-  return 2*pos + 2;
+static int first_child(heap_s const *heap, int pos) {
+  return (pos << heap->log2_arity) + 1;
 }
 
-int parent(int pos) {
-  return (pos - 1)/2;
+static int parent(heap_s const *heap, int pos) {
+  return (pos - 1) >> heap->log2_arity;
 }
 
-dbl value(heap_s *heap, int pos) {
+static dbl get_key(heap_s const *heap, int pos) {
   assert(pos >= 0);
   assert(pos < heap->size);
 
 #ifdef SJS_DEBUG
-  int ind = heap->inds[pos];
+  int ind = heap->elts[pos].ind;
   assert(ind != NO_INDEX);
 #endif
 
-  return heap->value(heap->context, heap->inds[pos]);
+  return heap->elts[pos].key;
 }
 
-void heap_set(heap_s *heap, int pos, int ind) {
+void heap_set(heap_s *heap, int pos, heap_elt_s elt) {
   assert(pos >= 0);
   assert(pos < heap->size);
 
-  heap->inds[pos] = ind;
-  heap->setpos(heap->context, ind, pos);
+  heap->elts[pos] = elt;
+  heap->setpos(heap->context, elt.ind, pos);
 }
 
-void heap_swap(heap_s *heap, int pos1, int pos2) {
-  assert(pos1 >= 0);
-  assert(pos1 < heap->size);
-  assert(pos2 >= 0);
-  assert(pos2 < heap->size);
+/**
+ * The two functions below sift an element by moving a "hole" through
+ * the heap instead of repeatedly swapping elements. Each element
+ * that's displaced is written (and has its position set) exactly
+ * once, and the sifted element is only written when its final
+ * position is known.
+ */
 
-  int tmp = heap->inds[pos1];
-  heap->inds[pos1] = heap->inds[pos2];
-  heap->inds[pos2] = tmp;
+static void sift_up(heap_s *heap, int pos) {
+  heap_elt_s elt = heap->elts[pos];
+  int par;
+  while (pos > 0) {
+    par = parent(heap, pos);
+    if (get_key(heap, par) <= elt.key) {
+      break;
+    }
+    heap_set(heap, pos, heap->elts[par]);
+    pos = par;
+  }
+  heap_set(heap, pos, elt);
+}
 
-  heap_set(heap, pos1, heap->inds[pos1]);
-  heap_set(heap, pos2, heap->inds[pos2]);
+static void sift_down(heap_s *heap, int pos) {
+  heap_elt_s elt = heap->elts[pos];
+  int n = heap->size, ch, last, argmin;
+  dbl min;
+  while ((ch = first_child(heap, pos)) < n) {
+    last = ch + heap->arity < n ? ch + heap->arity : n;
+    argmin = ch;
+    min = get_key(heap, ch);
+    while (++ch < last) {
+      if (get_key(heap, ch) < min) {
+        argmin = ch;
+        min = get_key(heap, ch);
+      }
+    }
+    if (elt.key <= min) {
+      break;
+    }
+    heap_set(heap, pos, heap->elts[argmin]);
+    pos = argmin;
+  }
+  heap_set(heap, pos, elt);
 }
 
-// TODO: this calls `value` and `heap_set` about 2x as many times as
-// necessary
+/**
+ * Refresh the cached key of the element at position `pos` by calling
+ * `value`, and then move it up the heap. This is only correct if the
+ * element's key decreased.
+ */
 void heap_swim(heap_s *heap, int pos) {
+  if (heap->bucket != NULL) {
+    bucket_swim(heap->bucket, pos);
+    return;
+  }
+
   assert(pos >= 0);
   assert(pos < heap->size);
 
-  int par = parent(pos);
-  while (pos > 0 && value(heap, par) > value(heap, pos)) {
-    heap_swap(heap, par, pos);
-    pos = par;
-    par = parent(pos);
+  heap->elts[pos].key = heap->value(heap->context, heap->elts[pos].ind);
+  sift_up(heap, pos);
+}
+
+/**
+ * Set the key of the element at position `pos` to `key` and restore
+ * the heap property. This doesn't call `value`.
+ */
+void heap_update_key(heap_s *heap, int pos, dbl key) {
+  if (heap->bucket != NULL) {
+    bucket_update_key(heap->bucket, pos, key);
+    return;
+  }
+
+  assert(pos >= 0);
+  assert(pos < heap->size);
+
+  dbl old_key = heap->elts[pos].key;
+  heap->elts[pos].key = key;
+  if (key < old_key) {
+    sift_up(heap, pos);
+  } else if (key > old_key) {
+    sift_down(heap, pos);
   }
 }
 
 void heap_insert(heap_s *heap, int ind) {
+  if (heap->bucket != NULL) {
+    bucket_insert(heap->bucket, ind);
+    return;
+  }
+
   if (heap->size == heap->capacity) {
     heap_grow(heap);
   }
 
   int pos = heap->size++;
-  heap_set(heap, pos, ind);
-  heap_swim(heap, pos);
+  heap->elts[pos].key = heap->value(heap->context, ind);
+  heap->elts[pos].ind = ind;
+  sift_up(heap, pos);
 }
 
 int heap_front(heap_s *heap) {
+  if (heap->bucket != NULL) {
+    return bucket_front(heap->bucket);
+  }
+
 #if SJS_DEBUG
-  int ind = heap->inds[0];
+  int ind = heap->elts[0].ind;
   return ind;
 #else
-  return heap->inds[0];
+  return heap->elts[0].ind;
 #endif
 }
 
@@ -138,36 +228,72 @@ void heap_sink(heap_s *heap, int pos) {
   assert(pos >= 0);
   assert(pos < heap->size);
 
-  int ch = left(pos), next = ch + 1, n = heap->size;
-  dbl cval, nval;
-  while (ch < n) {
-    cval = value(heap, ch);
-    if (next < n) {
-      nval = value(heap, next);
-      if (cval > nval) {
-        ch = next;
-        cval = nval;
-      }
-    }
-    if (value(heap, pos) > cval) {
-      heap_swap(heap, pos, ch);
-    }
-    pos = ch;
-    ch = left(pos);
-    next = ch + 1;
-  }
+  sift_down(heap, pos);
 }
 
 void heap_pop(heap_s *heap) {
+  if (heap->bucket != NULL) {
+    bucket_pop(heap->bucket);
+    return;
+  }
+
 #if SJS_DEBUG
-  heap->setpos(heap->context, heap->inds[0], NO_INDEX);
+  heap->setpos(heap->context, heap->elts[0].ind, NO_INDEX);
 #endif
-  heap_swap(heap, 0, heap->size - 1);
   if (--heap->size > 0) {
+    heap->elts[0] = heap->elts[heap->size];
     heap_sink(heap, 0);
   }
 }
 
 int heap_size(heap_s *heap) {
-  return heap->size;
+  return heap->bucket != NULL ? bucket_size(heap->bucket) : heap->size;
+}
+
+/**
+ * Set the number of children of each node in the heap. This must be
+ * a power of two. Wider heaps are shallower, which makes `heap_pop`
+ * touch fewer cache lines, at the cost of more key comparisons per
+ * level. This can be called at any time: if the heap isn't empty, it
+ * will be rebuilt in place.
+ */
+void heap_set_arity(heap_s *heap, int arity) {
+  assert(arity >= 2);
+  assert((arity & (arity - 1)) == 0);
+
+  heap->arity = arity;
+  heap->log2_arity = 0;
+  while ((1 << heap->log2_arity) < arity) {
+    ++heap->log2_arity;
+  }
+
+  for (int pos = parent(heap, heap->size - 1); pos >= 0; --pos) {
+    sift_down(heap, pos);
+  }
+}
+
+int heap_get_arity(heap_s const *heap) {
+  return heap->arity;
+}
+
+/**
+ * Replace the heap with an untidy bucket queue whose buckets have
+ * width `width` (see bucket.c for a discussion of how to choose
+ * `width` and the resulting tradeoff between speed and accuracy). All
+ * of the other `heap_*` functions forward to the bucket queue
+ * afterwards. Any elements currently in the heap are moved into the
+ * bucket queue.
+ */
+void heap_use_buckets(heap_s *heap, dbl width) {
+  assert(heap->bucket == NULL);
+
+  bucket_alloc(&heap->bucket);
+  bucket_init(heap->bucket, heap->capacity, width, heap->value, heap->setpos,
+              heap->context);
+
+  for (int pos = 0; pos < heap->size; ++pos) {
+    bucket_insert_with_key(heap->bucket, heap->elts[pos].ind,
+                           heap->elts[pos].key);
+  }
+  heap->size = 0;
 }
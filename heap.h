@@ -18,9 +18,13 @@ void heap_init(heap_s *heap, int capacity, value_f value, setpos_f setpos,
 void heap_deinit(heap_s *heap);
 void heap_insert(heap_s *heap, int ind);
 void heap_swim(heap_s *heap, int ind);
+void heap_update_key(heap_s *heap, int pos, dbl key);
 int heap_front(heap_s *heap);
 void heap_pop(heap_s *heap);
 int heap_size(heap_s *heap);
+void heap_set_arity(heap_s *heap, int arity);
+int heap_get_arity(heap_s const *heap);
+void heap_use_buckets(heap_s *heap, dbl width);
 
 #ifdef __cplusplus
 }
@@ -3,11 +3,49 @@
 #include "def.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stddef.h>
 
+#if ORDERING == TILED_ORDERING
+/**
+ * With `TILED_ORDERING`, the grid is split into TILE_SIZE x
+ * TILE_SIZE tiles, which are stored in row-major order. The nodes in
+ * each tile are stored contiguously, also in row-major order. If the
+ * shape isn't a multiple of TILE_SIZE, the last row and column of
+ * tiles are only partially used.
+ *
+ * Cells are indexed using the index of their upper-left vertex, so
+ * the `l` and `lc` index spaces coincide in this case.
+ */
+
+#define TILE_MASK (TILE_SIZE - 1)
+
+static int num_tiles(int n) {
+  return (n + TILE_MASK) >> LOG2_TILE_SIZE;
+}
+
+static int tiled_ind2l(ivec2 shape, ivec2 ind) {
+  int t = (ind.i >> LOG2_TILE_SIZE)*num_tiles(shape.j) +
+    (ind.j >> LOG2_TILE_SIZE);
+  return (t << 2*LOG2_TILE_SIZE) + ((ind.i & TILE_MASK) << LOG2_TILE_SIZE) +
+    (ind.j & TILE_MASK);
+}
+
+static ivec2 tiled_l2ind(ivec2 shape, int l) {
+  int t = l >> 2*LOG2_TILE_SIZE, ntj = num_tiles(shape.j);
+  ivec2 ind = {
+    .i = ((t/ntj) << LOG2_TILE_SIZE) + ((l >> LOG2_TILE_SIZE) & TILE_MASK),
+    .j = ((t % ntj) << LOG2_TILE_SIZE) + (l & TILE_MASK)
+  };
+  return ind;
+}
+#endif
+
 int ind2l(ivec2 shape, ivec2 ind) {
 #if ORDERING == ROW_MAJOR_ORDERING
   return ind.j + shape.j*ind.i;
+#elif ORDERING == TILED_ORDERING
+  return tiled_ind2l(shape, ind);
 #else
   return shape.i*ind.j + ind.i;
 #endif
@@ -16,6 +54,8 @@ int ind2l(ivec2 shape, ivec2 ind) {
 int ind2lc(ivec2 shape, ivec2 ind) {
 #if ORDERING == ROW_MAJOR_ORDERING
   return ind.j + (shape.j - 1)*ind.i;
+#elif ORDERING == TILED_ORDERING
+  return tiled_ind2l(shape, ind);
 #else
   return (shape.i - 1)*ind.j + ind.i;
 #endif
@@ -24,6 +64,8 @@ int ind2lc(ivec2 shape, ivec2 ind) {
 int indc2l(ivec2 shape, ivec2 indc) {
 #if ORDERING == ROW_MAJOR_ORDERING
   return indc.j + shape.j*indc.i;
+#elif ORDERING == TILED_ORDERING
+  return tiled_ind2l(shape, indc);
 #else
   return shape.i*indc.j + indc.i;
 #endif
@@ -32,6 +74,8 @@ int indc2l(ivec2 shape, ivec2 indc) {
 int indc2lc(ivec2 shape, ivec2 indc) {
 #if ORDERING == ROW_MAJOR_ORDERING
   return indc.j + (shape.j - 1)*indc.i;
+#elif ORDERING == TILED_ORDERING
+  return tiled_ind2l(shape, indc);
 #else
   return (shape.i - 1)*indc.j + indc.i;
 #endif
@@ -40,6 +84,8 @@ int indc2lc(ivec2 shape, ivec2 indc) {
 ivec2 l2ind(ivec2 shape, int l) {
 #if ORDERING == ROW_MAJOR_ORDERING
   ivec2 ind = {.i = l/shape.j, .j = l % shape.j};
+#elif ORDERING == TILED_ORDERING
+  ivec2 ind = tiled_l2ind(shape, l);
 #else
   ivec2 ind = {.i = l % shape.i, .j = l/shape.i};
 #endif
@@ -49,6 +95,8 @@ ivec2 l2ind(ivec2 shape, int l) {
 ivec2 l2indc(ivec2 shape, int l) {
 #if ORDERING == ROW_MAJOR_ORDERING
   ivec2 indc = {.i = l/shape.j, .j = l % shape.j};
+#elif ORDERING == TILED_ORDERING
+  ivec2 indc = tiled_l2ind(shape, l);
 #else
   ivec2 indc = {.i = l % shape.i, .j = l/shape.i};
 #endif
@@ -58,6 +106,8 @@ ivec2 l2indc(ivec2 shape, int l) {
 ivec2 lc2ind(ivec2 shape, int lc) {
 #if ORDERING == ROW_MAJOR_ORDERING
   ivec2 ind = {.i = lc/(shape.j - 1), .j = lc % (shape.j - 1)};
+#elif ORDERING == TILED_ORDERING
+  ivec2 ind = tiled_l2ind(shape, lc);
 #else
   ivec2 ind = {.i = lc % (shape.i - 1), .j = lc/(shape.i - 1)};
 #endif
@@ -67,6 +117,8 @@ ivec2 lc2ind(ivec2 shape, int lc) {
 ivec2 lc2indc(ivec2 shape, int lc) {
 #if ORDERING == ROW_MAJOR_ORDERING
   ivec2 indc = {.i = lc/(shape.j - 1), .j = lc % (shape.j - 1)};
+#elif ORDERING == TILED_ORDERING
+  ivec2 indc = tiled_l2ind(shape, lc);
 #else
   ivec2 indc = {.i = lc % (shape.i - 1), .j = lc/(shape.i - 1)};
 #endif
@@ -76,6 +128,9 @@ ivec2 lc2indc(ivec2 shape, int lc) {
 int l2lc(ivec2 shape, int l) {
 #if ORDERING == ROW_MAJOR_ORDERING
   return l - l/shape.j;
+#elif ORDERING == TILED_ORDERING
+  (void)shape;
+  return l;
 #else
   return l - l/shape.i;
 #endif
@@ -84,41 +139,55 @@ int l2lc(ivec2 shape, int l) {
 int lc2l(ivec2 shape, int lc) {
 #if ORDERING == ROW_MAJOR_ORDERING
   return lc + lc/(shape.j - 1);
+#elif ORDERING == TILED_ORDERING
+  (void)shape;
+  return lc;
 #else
   return lc + lc/(shape.i - 1);
 #endif
 }
 
+/**
+ * Find the cell containing `xy` and its coordinates `cc` in that
+ * cell. Points outside the grid are moved to the nearest point on its
+ * boundary. If `xy` isn't finite, this returns `NO_INDEX` and leaves
+ * `cc` alone.
+ */
 int xy_to_lc_and_cc(ivec2 shape, dvec2 xymin, dbl h, dvec2 xy, dvec2 *cc) {
 #if SJS_DEBUG
   assert(cc != NULL);
 #endif
 
+  if (!isfinite(xy.x) || !isfinite(xy.y)) {
+    return NO_INDEX;
+  }
+
   *cc = dvec2_sub(xy, xymin);
   *cc = dvec2_dbl_div(*cc, h);
   dvec2 ind_ = dvec2_floor(*cc);
   *cc = dvec2_sub(*cc, ind_);
-  ivec2 ind = dvec2_to_ivec2(ind_);
 
-  if (ind.i < 0) {
-    ind.i = 0;
+  // Clamp before converting to ints, since a point far outside the
+  // grid can be out of the range of an int
+  if (ind_.x < 0) {
+    ind_.x = 0;
     cc->x = 0.0;
   }
 
-  if (ind.j < 0) {
-    ind.j = 0;
+  if (ind_.y < 0) {
+    ind_.y = 0;
     cc->y = 0.0;
   }
 
-  if (ind.i >= shape.i - 1) {
-    --ind.i;
+  if (ind_.x > shape.i - 2) {
+    ind_.x = shape.i - 2;
     cc->x = 1.0;
   }
 
-  if (ind.j >= shape.j - 1) {
-    --ind.j;
+  if (ind_.y > shape.j - 2) {
+    ind_.y = shape.j - 2;
     cc->y = 1.0;
   }
 
-  return ind2lc(shape, ind);
+  return ind2lc(shape, dvec2_to_ivec2(ind_));
 }
@@ -10,6 +10,15 @@ typedef struct jet {
   dbl f, fx, fy, fxy;
 } jet_s;
 
+/**
+ * Pointers to the `f`, `fx`, `fy`, and `fxy` values of a jet stored in
+ * an array. Depending on how the array is stored, these can either
+ * point into an array of `jet_s` or into four separate arrays.
+ */
+typedef struct jet_ptrs {
+  dbl *f, *fx, *fy, *fxy;
+} jet_ptrs_s;
+
 #ifdef __cplusplus
 }
 #endif
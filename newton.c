@@ -0,0 +1,92 @@
+#include "newton.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "math.h"
+
+/**
+ * Find a root of `f` in [a, b] using Newton's method, starting from
+ * `x`, or from where the secant through the endpoints crosses zero if
+ * `x` isn't in (a, b) (e.g. if it's NAN). Calling
+ * `f(x, &df, context)` should return f(x) and set `df` to f'(x). If
+ * the second argument is NULL, only f(x) is needed.
+ *
+ * This is a drop-in replacement for `hybrid` for when f' is cheap to
+ * compute along with f: the endpoints are handled in the same way,
+ * and a bracket of the root is maintained. Newton steps which would
+ * leave the bracket, or which don't shrink it quickly enough, are
+ * replaced by bisection steps, so this always converges.
+ */
+dbl newton(dbl (*f)(dbl, dbl *, void *), dbl a, dbl b, dbl x,
+           void *context) {
+  dbl fa = f(a, NULL, context);
+  if (fabs(fa) <= EPS) {
+    return a;
+  }
+
+  dbl fb = f(b, NULL, context);
+  if (fabs(fb) <= EPS) {
+    return b;
+  }
+
+  if (sgn(fa) == sgn(fb)) {
+    return sgn(fa) == 1 ? a : b;
+  }
+
+  // The bracket [lo, hi] is oriented so that f(lo) < 0 < f(hi)
+  dbl lo = fa < 0 ? a : b, hi = fa < 0 ? b : a;
+
+  if (!(fmin(a, b) < x && x < fmax(a, b))) {
+    x = a - fa*(b - a)/(fb - fa);
+  }
+
+  dbl dx = fabs(b - a), dx_prev = dx, fx, dfx, x_newton;
+  bool newton_prev = false;
+  for (;;) {
+    fx = f(x, &dfx, context);
+    if (fx == 0) {
+      break;
+    }
+    if (fx < 0) {
+      lo = x;
+    } else {
+      hi = x;
+    }
+
+    // Stop once the Newton step is small enough. This also covers the
+    // case where f(x) is at the level of roundoff error, in which
+    // case x_newton may land on the edge of the bracket.
+    x_newton = x - fx/dfx;
+    if (fabs(x_newton - x) <= EPS) {
+      x = x_newton;
+      break;
+    }
+
+    dx_prev = dx;
+    if (fmin(lo, hi) < x_newton && x_newton < fmax(lo, hi) &&
+        fabs(2*fx) <= fabs(dx_prev*dfx)) {
+      dx = fabs(x_newton - x);
+      x = x_newton;
+
+      // Newton's method converges quadratically, so if the last two
+      // steps were Newton steps, the next one should be about
+      // dx^3/dx_prev^2. If that's small enough, there's no need to
+      // evaluate f again.
+      if (newton_prev && dx*dx*dx <= EPS*dx_prev*dx_prev) {
+        break;
+      }
+      newton_prev = true;
+    } else {
+      dx = fabs(hi - lo)/2;
+      x = (lo + hi)/2;
+      newton_prev = false;
+    }
+
+    if (dx <= EPS) {
+      break;
+    }
+  }
+  return x;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "def.h"
+
+dbl newton(dbl (*f)(dbl, dbl *, void *), dbl a, dbl b, dbl x,
+           void *context);
+
+#ifdef __cplusplus
+}
+#endif
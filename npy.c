@@ -4,7 +4,13 @@
 
 #include <stdio.h>
 
-void npy_write_2d_dbl_array(char const *filename, void *data, int m, int n, int stride) {
+/**
+ * Write the `m` by `n` array of doubles starting at `data` to
+ * `filename`. The strides (in bytes) between consecutive elements
+ * along each axis are `stride_i` and `stride_j`.
+ */
+void npy_write_2d_dbl_array(char const *filename, void const *data, int m,
+                            int n, int stride_i, int stride_j) {
   FILE *stream = fopen(filename, "w");
 
   /**
@@ -50,9 +56,15 @@ void npy_write_2d_dbl_array(char const *filename, void *data, int m, int n, int
   fputc('\n', stream);
 
   // Write the data
+  char const *bytes = (char const *)data;
   for (int i = 0; i < m; ++i) {
+    // If the rows are contiguous, write each of them all at once
+    if (stride_j == sizeof(dbl)) {
+      fwrite(&bytes[stride_i*i], sizeof(dbl), n, stream);
+      continue;
+    }
     for (int j = 0; j < n; ++j) {
-      fwrite(&data[stride*(n*i + j)], sizeof(dbl), 1, stream);
+      fwrite(&bytes[stride_i*i + stride_j*j], sizeof(dbl), 1, stream);
     }
   }
 
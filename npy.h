@@ -4,7 +4,8 @@
 extern "C" {
 #endif
 
-void npy_write_2d_dbl_array(char const *filename, void *data, int m, int n, int stride);
+void npy_write_2d_dbl_array(char const *filename, void const *data, int m,
+                            int n, int stride_i, int stride_j);
 
 #ifdef __cplusplus
 }
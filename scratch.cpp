@@ -3,6 +3,9 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
 
 #define MAX(x, y) x > y ? x : y
 #define VX 0.133
@@ -40,6 +43,82 @@ dvec2 grad_s(dbl x, dbl y, void *context) {
   return (dvec2) {.x = sx(x, y), .y = sy(x, y)};
 }
 
+dmat22 hess_s(dbl x, dbl y, void *context) {
+  (void) context;
+  dbl tmp = 2*pow(s(x, y, NULL), 3.0);
+  dmat22 hess;
+  hess.data[0][0] = VX*VX*tmp;
+  hess.data[0][1] = sxy(x, y);
+  hess.data[1][0] = sxy(x, y);
+  hess.data[1][1] = VY*VY*tmp;
+  return hess;
+}
+
+// A rough slowness used for benchmarking: `s` modulated by a
+// product of sines. We don't know the solution for this one, so the
+// initial data is set up assuming the rays near the source are
+// straight (see `rough_jet`).
+
+#define ROUGH_A 0.1
+#define ROUGH_K (4*M_PI)
+
+dbl s_rough(dbl x, dbl y, void *context) {
+  (void) context;
+  dbl m = 1 + ROUGH_A*sin(ROUGH_K*x)*sin(ROUGH_K*y);
+  return m*s(x, y, NULL);
+}
+
+dvec2 grad_s_rough(dbl x, dbl y, void *context) {
+  (void) context;
+  dbl sin_x = sin(ROUGH_K*x), cos_x = cos(ROUGH_K*x);
+  dbl sin_y = sin(ROUGH_K*y), cos_y = cos(ROUGH_K*y);
+  dbl m = 1 + ROUGH_A*sin_x*sin_y;
+  dbl mx = ROUGH_A*ROUGH_K*cos_x*sin_y;
+  dbl my = ROUGH_A*ROUGH_K*sin_x*cos_y;
+  return (dvec2) {
+    .x = mx*s(x, y, NULL) + m*sx(x, y),
+    .y = my*s(x, y, NULL) + m*sy(x, y)
+  };
+}
+
+dmat22 hess_s_rough(dbl x, dbl y, void *context) {
+  (void) context;
+  dbl sin_x = sin(ROUGH_K*x), cos_x = cos(ROUGH_K*x);
+  dbl sin_y = sin(ROUGH_K*y), cos_y = cos(ROUGH_K*y);
+  dbl m = 1 + ROUGH_A*sin_x*sin_y;
+  dbl mx = ROUGH_A*ROUGH_K*cos_x*sin_y;
+  dbl my = ROUGH_A*ROUGH_K*sin_x*cos_y;
+  dbl mxx = -ROUGH_A*ROUGH_K*ROUGH_K*sin_x*sin_y;
+  dbl mxy = ROUGH_A*ROUGH_K*ROUGH_K*cos_x*cos_y;
+  dmat22 hess = hess_s(x, y, NULL);
+  hess.data[0][0] = mxx*s(x, y, NULL) + 2*mx*sx(x, y) + m*hess.data[0][0];
+  hess.data[0][1] = mxy*s(x, y, NULL) + mx*sy(x, y) + my*sx(x, y)
+    + m*hess.data[0][1];
+  hess.data[1][0] = hess.data[0][1];
+  hess.data[1][1] = mxx*s(x, y, NULL) + 2*my*sy(x, y) + m*hess.data[1][1];
+  return hess;
+}
+
+// The jet of T at (x, y) for the rough slowness, assuming the rays
+// from the source at the origin are straight (like `add_point_source`
+// in eik.c): T is integrated along the ray using the trapezoid rule,
+// and grad T has length `s_rough` and points away from the source.
+
+jet rough_jet(dbl x, dbl y) {
+  dbl L = sqrt(normsq(x, y)), L_cubed = L*L*L;
+  if (L == 0) {
+    return (jet) {0, 0, 0, 0};
+  }
+  dbl s0 = s_rough(0, 0, NULL), s1 = s_rough(x, y, NULL);
+  dvec2 grad_s1 = grad_s_rough(x, y, NULL);
+  return (jet) {
+    .f = L*(s0 + s1)/2,
+    .fx = s1*x/L,
+    .fy = s1*y/L,
+    .fxy = grad_s1.y*x/L - s1*x*y/L_cubed
+  };
+}
+
 // Note: below, `u` is the solution of |grad(tau)| = s, with s defined
 // as above. We write `u` in terms of an auxiliary function we define
 // below called `f`. This makes it simpler to write down its partial
@@ -86,27 +165,151 @@ dbl uxy(dbl x, dbl y) {
   return (d2acosh(tmp)*fx(x, y)*fy(x, y) + dacosh(tmp)*fxy(x, y))/VNORM;
 }
 
+static dbl toc(struct timespec const *tic) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (t.tv_sec - tic->tv_sec) + (t.tv_nsec - tic->tv_nsec)/1e9;
+}
+
+static void usage(char const *argv0) {
+  printf("usage: %s <N> [-a <heap arity>] [-b <bucket width/(h*s_min)>]\n"
+         "       [-f] [-H] [-n] [-p <tiles>] [-q] [-r] [-s <tol>] [-t]\n"
+         "       [-T <Tmax>] [-u] [-w]\n"
+         "\n"
+         "  -f  solve using the fast iterative method (see eik_solve_fim)\n"
+         "  -H  don't provide the Hessian of the slowness\n"
+         "  -n  minimize F4 using Newton's method instead of DFP\n"
+         "  -p  solve in parallel, splitting the grid into <tiles> by\n"
+         "      <tiles> tiles (see eik_solve_parallel)\n"
+         "  -q  don't write T.npy, Tx.npy, etc.\n"
+         "  -r  use a rough slowness (whose solution isn't known)\n"
+         "  -s  solve by sweeping until T and grad T change by less than\n"
+         "      <tol> (see eik_solve_sweep); with -p, sweep <tiles> by\n"
+         "      <tiles> tiles in parallel\n"
+         "  -t  interpolate the slowness sampled on the grid\n"
+         "  -T  stop once every node with T <= <Tmax> is valid (see\n"
+         "      eik_solve_until_T)\n"
+         "  -u  update the neighbors of each accepted node in parallel\n"
+         "      (see eik_set_parallel_updates)\n"
+         "  -w  don't warm start triangle updates (see\n"
+         "      eik_set_use_warm_start)\n",
+         argv0);
+  exit(EXIT_FAILURE);
+}
+
 int main(int argc, char *argv[]) {
-  if (argc != 2) {
-    printf("usage: %s <N>\n", argv[0]);
-    exit(EXIT_FAILURE);
+  int arity = HEAP_ARITY;
+  dbl bucket_width = 0;
+  bool write_npy = true;
+  bool use_hess = true;
+  bool use_newton = false;
+  bool use_tab = false;
+  bool parallel_updates = false;
+  bool use_warm_start = true;
+  int num_tiles = 0;
+  bool use_fim = false;
+  bool use_rough = false;
+  dbl sweep_tol = 0;
+  dbl Tmax = INFINITY;
+
+  int c;
+  while ((c = getopt(argc, argv, "a:b:fHnp:qrs:tT:uw")) != -1) {
+    switch (c) {
+    case 'a':
+      arity = atoi(optarg);
+      break;
+    case 'b':
+      bucket_width = atof(optarg);
+      break;
+    case 'f':
+      use_fim = true;
+      break;
+    case 'H':
+      use_hess = false;
+      break;
+    case 'n':
+      use_newton = true;
+      break;
+    case 'p':
+      num_tiles = atoi(optarg);
+      break;
+    case 'q':
+      write_npy = false;
+      break;
+    case 'r':
+      use_rough = true;
+      break;
+    case 's':
+      sweep_tol = atof(optarg);
+      break;
+    case 't':
+      use_tab = true;
+      break;
+    case 'T':
+      Tmax = atof(optarg);
+      break;
+    case 'u':
+      parallel_updates = true;
+      break;
+    case 'w':
+      use_warm_start = false;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc - 1 || (use_newton && !use_hess) ||
+      (use_fim && (num_tiles > 0 || sweep_tol > 0))) {
+    usage(argv[0]);
   }
 
   eik * scheme;
   eik_alloc(&scheme);
 
   field2_s slow = {
-    .f = s,
-    .grad_f = grad_s,
-    .context = NULL
+    .f = use_rough ? s_rough : s,
+    .grad_f = use_rough ? grad_s_rough : grad_s,
+    .hess_f = use_hess ? (use_rough ? hess_s_rough : hess_s) : NULL,
+    .context = NULL,
+    .f_batch = NULL,
+    .grad_f_batch = NULL
   };
 
-  int N = atoi(argv[1]);
+  int N = atoi(argv[optind]);
   int i0 = N/2;
   ivec2 shape = {N, N};
   dvec2 xymin = {-1, -1};
   dbl h = 2.0/(N-1);
+
+  field2_tab_s *tab = NULL;
+  if (use_tab) {
+    dbl *values = (dbl *)malloc(N*N*sizeof(dbl));
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        values[N*i + j] = slow.f(h*i + xymin.x, h*j + xymin.y, NULL);
+      }
+    }
+    field2_tab_alloc(&tab);
+    field2_tab_init(tab, shape, xymin, h, values);
+    free(values);
+    slow = field2_tab_get_field2(tab);
+    if (!use_hess) {
+      slow.hess_f = NULL;
+    }
+  }
   eik_init(scheme, &slow, shape, xymin, h);
+  heap_set_arity(eik_get_heap(scheme), arity);
+  eik_set_use_newton(scheme, use_newton);
+  eik_set_parallel_updates(scheme, parallel_updates);
+  eik_set_use_warm_start(scheme, use_warm_start);
+  dbl s_min = 1.0/(1.0 + fabs(VX) + fabs(VY));
+  if (use_rough) {
+    s_min *= 1 - ROUGH_A;
+  }
+  eik_set_s_min(scheme, s_min);
+  if (bucket_width > 0) {
+    heap_use_buckets(eik_get_heap(scheme), bucket_width*h*s_min);
+  }
 
   int R = N/20;
   if (R < 5) R = 5;
@@ -134,7 +337,8 @@ int main(int argc, char *argv[]) {
   // }
 
   /**
-   * Initialize inside disk.
+   * Initialize inside disk. With -r, the jets are taken from
+   * `rough_jet` instead of `u`.
    */
   for (int i = 0; i < N; ++i) {
     int di = i - i0, di_sq = di*di;
@@ -144,7 +348,8 @@ int main(int argc, char *argv[]) {
       if (r < R) {
         dbl x = h*i + xymin.x;
         dbl y = h*j + xymin.y;
-        jet J = {u(x, y), ux(x, y), uy(x, y), uxy(x, y)};
+        jet J = use_rough ? rough_jet(x, y) :
+          (jet) {u(x, y), ux(x, y), uy(x, y), uxy(x, y)};
         eik_add_valid(scheme, (ivec2) {i, j}, J);
       }
     }
@@ -167,7 +372,8 @@ int main(int argc, char *argv[]) {
             if (state != VALID && state != TRIAL) {
               dbl x = h*i_ + xymin.x;
               dbl y = h*j_ + xymin.y;
-              jet J = {u(x, y), ux(x, y), uy(x, y), uxy(x, y)};
+              jet J = use_rough ? rough_jet(x, y) :
+                (jet) {u(x, y), ux(x, y), uy(x, y), uxy(x, y)};
               eik_add_trial(scheme, ind_, J);
             }
           }
@@ -178,15 +384,95 @@ int main(int argc, char *argv[]) {
 
   eik_build_cells(scheme);
 
-  eik_solve(scheme);
+  struct timespec tic;
+  clock_gettime(CLOCK_MONOTONIC, &tic);
+  char const *solver = "eik_solve";
+  bool converged = true;
+  if (sweep_tol > 0) {
+    int n = num_tiles > 0 ? num_tiles : 1;
+    converged = eik_solve_sweep(scheme, sweep_tol, (ivec2) {n, n});
+    solver = "eik_solve_sweep";
+  } else if (num_tiles > 0) {
+    eik_solve_parallel(scheme, (ivec2) {num_tiles, num_tiles});
+    solver = "eik_solve_parallel";
+  } else if (use_fim) {
+    eik_solve_fim(scheme);
+    solver = "eik_solve_fim";
+  } else if (isfinite(Tmax)) {
+    eik_solve_until_T(scheme, Tmax);
+    solver = "eik_solve_until_T";
+  } else {
+    eik_solve(scheme);
+  }
+  dbl t_solve = toc(&tic);
+  printf("%s: %g s\n", solver, t_solve);
+  if (!converged) {
+    printf("stopped before the change in T and grad T was within %g\n",
+           sweep_tol);
+  }
 
-  jet_s *jets = eik_get_jets_ptr(scheme);
+  eik_stats_s stats = eik_get_stats(scheme);
+  long num_updates = stats.num_line_updates + stats.num_tri_updates;
+  printf("updates: %ld line, %ld tri (%g updates/s)\n",
+         stats.num_line_updates, stats.num_tri_updates,
+         num_updates/t_solve);
+  printf("pruned: %ld line, %ld tri (see eik_set_s_min)\n",
+         stats.num_pruned_line_updates, stats.num_pruned_tri_updates);
+  printf("F4 iterations: %g per tri update (%ld warm starts)\n",
+         (dbl)stats.num_bfgs_iters/stats.num_tri_updates,
+         stats.num_warm_starts);
+
+  // ru_maxrss is in kilobytes on Linux
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  printf("peak memory: %g MB\n", usage.ru_maxrss/1024.0);
+
+  if (!use_rough) {
+    dbl max_error = 0;
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        dbl x = h*i + xymin.x;
+        dbl y = h*j + xymin.y;
+        if (eik_get_state(scheme, (ivec2) {i, j}) != VALID)
+          continue;
+        dbl T = eik_get_jet(scheme, (ivec2) {i, j}).f;
+        max_error = fmax(max_error, fabs(T - u(x, y)));
+      }
+    }
+    printf("max |T - u|: %g\n", max_error);
+  }
 
-  npy_write_2d_dbl_array("T.npy", &jets[0].f, N, N, sizeof(jet_s));
-  npy_write_2d_dbl_array("Tx.npy", &jets[0].fx, N, N, sizeof(jet_s));
-  npy_write_2d_dbl_array("Ty.npy", &jets[0].fy, N, N, sizeof(jet_s));
-  npy_write_2d_dbl_array("Txy.npy", &jets[0].fxy, N, N, sizeof(jet_s));
+  if (write_npy) {
+#if ORDERING == TILED_ORDERING
+    // The tiled layout can't be described using strides, so copy the
+    // jets into a row-major array first.
+    jet_s *jets = (jet_s *)malloc(N*N*sizeof(jet_s));
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        jets[N*i + j] = eik_get_jet(scheme, (ivec2) {i, j});
+      }
+    }
+    jet_ptrs_s ptrs = {&jets[0].f, &jets[0].fx, &jets[0].fy, &jets[0].fxy};
+    int si = sizeof(jet_s)*N, sj = sizeof(jet_s);
+#else
+    jet_ptrs_s ptrs = eik_get_jet_ptrs(scheme);
+    ivec2 strides = eik_get_jet_strides(scheme);
+    int si = sizeof(dbl)*strides.i, sj = sizeof(dbl)*strides.j;
+#endif
+    npy_write_2d_dbl_array("T.npy", ptrs.f, N, N, si, sj);
+    npy_write_2d_dbl_array("Tx.npy", ptrs.fx, N, N, si, sj);
+    npy_write_2d_dbl_array("Ty.npy", ptrs.fy, N, N, si, sj);
+    npy_write_2d_dbl_array("Txy.npy", ptrs.fxy, N, N, si, sj);
+#if ORDERING == TILED_ORDERING
+    free(jets);
+#endif
+  }
 
   eik_deinit(scheme);
   eik_dealloc(&scheme);
+
+  if (use_tab) {
+    field2_tab_deinit(tab);
+    field2_tab_dealloc(&tab);
+  }
 }
@@ -15,6 +15,7 @@ namespace py = pybind11;
 #include "hybrid.h"
 #include "index.h"
 #include "jet.h"
+#include "newton.h"
 #include "vec.h"
 
 static dbl value_wrapper(void * vp, int l);
@@ -73,19 +74,49 @@ static dbl f_wrapper(dbl t, void * context) {
   return (*(std::function<dbl(dbl)> *) context)(t);
 }
 
+static dbl f_df_wrapper(dbl t, dbl * df, void * context) {
+  auto const tmp = (*(std::function<std::pair<dbl, dbl>(dbl)> *) context)(t);
+  if (df != nullptr) {
+    *df = tmp.second;
+  }
+  return tmp.first;
+}
+
 dbl field_f_wrapper(dbl x, dbl y, void *context);
 dvec2 field_grad_f_wrapper(dbl x, dbl y, void *context);
+dmat22 field_hess_f_wrapper(dbl x, dbl y, void *context);
 
 struct field2_wrapper {
   field2 field;
 
   std::function<dbl(dbl, dbl)> f;
   std::function<std::array<dbl, 2>(dbl, dbl)> grad_f;
-
-  field2_wrapper(decltype(f) const & f, decltype(grad_f) const & grad_f):
-    field {field_f_wrapper, field_grad_f_wrapper, (void *)this},
+  std::optional<
+    std::function<std::array<std::array<dbl, 2>, 2>(dbl, dbl)>> hess_f;
+
+  // Set if this field is evaluated natively (see `from_array`,
+  // `constant`, and `linear_speed` below), in which case this owns
+  // `field.context`
+  std::shared_ptr<void> native;
+
+  field2_wrapper(decltype(f) const & f, decltype(grad_f) const & grad_f,
+                 decltype(hess_f) const & hess_f = std::nullopt):
+    field {
+      field_f_wrapper,
+      field_grad_f_wrapper,
+      hess_f ? field_hess_f_wrapper : nullptr,
+      (void *)this,
+      nullptr,
+      nullptr
+    },
     f {f},
-    grad_f {grad_f}
+    grad_f {grad_f},
+    hess_f {hess_f}
+  {}
+
+  field2_wrapper(field2 const & field, std::shared_ptr<void> const & native):
+    field {field},
+    native {native}
   {}
 };
 
@@ -100,6 +131,16 @@ dvec2 field_grad_f_wrapper(dbl x, dbl y, void *context) {
   return {tmp[0], tmp[1]};
 }
 
+dmat22 field_hess_f_wrapper(dbl x, dbl y, void *context) {
+  field2_wrapper * wrap = (field2_wrapper *) context;
+  auto const tmp = (*wrap->hess_f)(x, y);
+  dmat22 hess;
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      hess.data[i][j] = tmp[i][j];
+  return hess;
+}
+
 struct eik_wrapper {
   field2_wrapper slow;
   eik * ptr {nullptr};
@@ -126,6 +167,68 @@ struct eik_wrapper {
   }
 };
 
+/**
+ * Get an array of one of the members of the jets stored by the Eik
+ * `obj`. The array is a view of the jets (kept alive by `obj`),
+ * unless the grid is tiled, in which case it's a copy.
+ */
+static py::array_t<dbl> get_jet_values(py::object obj,
+                                       dbl * jet_ptrs::* member) {
+  eik_wrapper const & w = obj.cast<eik_wrapper const &>();
+  ivec2 shape = eik_get_shape(w.ptr);
+#if ORDERING == TILED_ORDERING
+  py::array_t<dbl> values({shape.i, shape.j});
+  auto values_ = values.mutable_unchecked<2>();
+  for (int i = 0; i < shape.i; ++i) {
+    for (int j = 0; j < shape.j; ++j) {
+      jet_s jet = eik_get_jet(w.ptr, {i, j});
+      jet_ptrs_s ptrs {&jet.f, &jet.fx, &jet.fy, &jet.fxy};
+      values_(i, j) = *(ptrs.*member);
+    }
+  }
+  return values;
+#else
+  ivec2 strides = eik_get_jet_strides(w.ptr);
+  return py::array_t<dbl> {
+    {shape.i, shape.j},
+    {sizeof(dbl)*strides.i, sizeof(dbl)*strides.j},
+    eik_get_jet_ptrs(w.ptr).*member,
+    obj
+  };
+#endif
+}
+
+using points_t = py::array_t<dbl, py::array::c_style | py::array::forcecast>;
+
+/**
+ * Get the number of points in `xy`, which should be an n by 2 array.
+ */
+static int get_num_points(points_t const & xy) {
+  if (xy.ndim() != 2 || xy.shape(1) != 2) {
+    throw std::invalid_argument {"xy must be an n by 2 array"};
+  }
+  return xy.shape(0);
+}
+
+/**
+ * Call one of `eik_T_batch`, etc. on the points `xy` and return the
+ * results in a new array. The GIL is released while querying.
+ */
+static py::array_t<dbl> query_batch(
+  eik_wrapper const & w, points_t const & xy,
+  void (* batch)(eik *, dvec2 const *, int, dbl *))
+{
+  int n = get_num_points(xy);
+  py::array_t<dbl> values(n);
+  dvec2 const * xy_ptr = (dvec2 const *) xy.data();
+  dbl * values_ptr = values.mutable_data();
+  {
+    py::gil_scoped_release release;
+    batch(w.ptr, xy_ptr, n, values_ptr);
+  }
+  return values;
+}
+
 PYBIND11_MODULE (_sjs, m) {
   m.doc() = R"pbdoc(
 _sjs
@@ -158,10 +261,11 @@ TODO!
     .def_property_readonly(
       "A",
       [] (bicubic const & B) {
+        dmat44 B_A = bicubic_get_A(&B);
         std::array<std::array<dbl, 4>, 4> A;
         for (int i = 0; i < 4; ++i) {
           for (int j = 0; j < 4; ++j) {
-            A[i][j] = B.A.rows[i].data[j];
+            A[i][j] = B_A.rows[i].data[j];
           }
         }
         return A;
@@ -197,6 +301,15 @@ TODO!
         return bicubic_get_fy_on_edge(&B, var, edge);
       }
     )
+    .def(
+      "get_cubics_on_edge",
+      [] (bicubic const & B, bicubic_variable var, int edge, bool reverse) {
+        cubic_s f, fx, fy;
+        bicubic_get_cubics_on_edge(&B, var, edge, reverse, &f, &fx, &fy);
+        return std::make_tuple(f, fx, fy);
+      },
+      py::arg("var"), py::arg("edge"), py::arg("reverse") = false
+    )
     .def(
       "f",
       [] (bicubic const & B, dbl lambda, dbl mu) {
@@ -290,11 +403,172 @@ TODO!
          >())
     .def(
       "step",
-      [] (eik_wrapper const & w) { eik_step(w.ptr); }
+      [] (eik_wrapper const & w) {
+        // Native fields never call back into Python, so other threads
+        // can run while we're solving. If the neighbors are updated
+        // in parallel, the GIL has to be released regardless, since
+        // each of the worker threads needs to acquire it to evaluate
+        // a Python field.
+        std::optional<py::gil_scoped_release> release;
+        if (w.slow.native || eik_get_parallel_updates(w.ptr))
+          release.emplace();
+        eik_step(w.ptr);
+      }
     )
     .def(
       "solve",
-      [] (eik_wrapper const & w) { eik_solve(w.ptr); }
+      [] (eik_wrapper const & w) {
+        std::optional<py::gil_scoped_release> release;
+        if (w.slow.native || eik_get_parallel_updates(w.ptr))
+          release.emplace();
+        eik_solve(w.ptr);
+      }
+    )
+    .def(
+      "solve_until_T",
+      [] (eik_wrapper const & w, dbl Tmax) {
+        // See "solve"
+        std::optional<py::gil_scoped_release> release;
+        if (w.slow.native || eik_get_parallel_updates(w.ptr))
+          release.emplace();
+        eik_solve_until_T(w.ptr, Tmax);
+      },
+      R"pbdoc(
+Solve until every node with T <= Tmax is Valid. The rest of the front
+is left Trial, so the solve can be resumed later.
+)pbdoc",
+      py::arg("Tmax")
+    )
+    .def(
+      "solve_until_targets",
+      [] (eik_wrapper const & w,
+          py::array_t<int, py::array::c_style | py::array::forcecast>
+            const & targets) {
+        if (targets.ndim() != 2 || targets.shape(1) != 2) {
+          throw std::invalid_argument {"targets must be an n by 2 array"};
+        }
+        ivec2 shape = eik_get_shape(w.ptr);
+        auto r = targets.unchecked<2>();
+        for (py::ssize_t k = 0; k < r.shape(0); ++k) {
+          if (r(k, 0) < 0 || r(k, 0) >= shape.i ||
+              r(k, 1) < 0 || r(k, 1) >= shape.j) {
+            throw std::out_of_range {"target out of range"};
+          }
+        }
+        // See "solve"
+        std::optional<py::gil_scoped_release> release;
+        if (w.slow.native || eik_get_parallel_updates(w.ptr))
+          release.emplace();
+        eik_solve_until_targets(
+          w.ptr, (ivec2 const *) targets.data(), targets.shape(0));
+      },
+      R"pbdoc(
+Solve until each of the nodes (i, j) in targets (an n by 2 array) and
+the cells incident on them are Valid, so that T can be interpolated
+near each of them.
+)pbdoc",
+      py::arg("targets")
+    )
+    .def(
+      "solve_parallel",
+      [] (eik_wrapper const & w, std::array<int, 2> const & num_tiles) {
+        // Always release the GIL: if the field calls back into
+        // Python, each of the worker threads needs to acquire it
+        py::gil_scoped_release release;
+        eik_solve_parallel(w.ptr, {num_tiles[0], num_tiles[1]});
+      },
+      R"pbdoc(
+Solve in parallel by splitting the domain into num_tiles[0] by
+num_tiles[1] tiles, each of which is solved separately, exchanging
+jets with its neighbors until they agree.
+)pbdoc",
+      py::arg("num_tiles")
+    )
+    .def(
+      "solve_fim",
+      [] (eik_wrapper const & w) {
+        // See "solve_parallel"
+        py::gil_scoped_release release;
+        eik_solve_fim(w.ptr);
+      },
+      R"pbdoc(
+Solve using a variant of the fast iterative method, which updates
+the nodes on the front in parallel and accepts the ones within
+h*s_min/(2*sqrt(2)) of the smallest value on the front together.
+)pbdoc"
+    )
+    .def(
+      "solve_sweep",
+      [] (eik_wrapper const & w, dbl tol,
+          std::array<int, 2> const & num_tiles) {
+        // See "solve_parallel"
+        py::gil_scoped_release release;
+        return eik_solve_sweep(w.ptr, tol, {num_tiles[0], num_tiles[1]});
+      },
+      R"pbdoc(
+Solve by fast sweeping, recomputing each node's jet while sweeping
+the grid in each of the four alternating orderings, until T and its
+gradient change by no more than tol. The sweeps are done in parallel
+by splitting the domain into num_tiles[0] by num_tiles[1] tiles,
+each at least four nodes wide. Returns False if sweeping stopped
+early because a round of sweeps didn't reduce the change (see
+eik_solve_sweep in eik.c), and True otherwise.
+)pbdoc",
+      py::arg("tol") = 1e-8,
+      py::arg("num_tiles") = std::array<int, 2> {1, 1}
+    )
+    .def_static(
+      "solve_batch",
+      [] (field2_wrapper const & slow, std::array<int, 2> const & shape,
+          std::array<dbl, 2> const & xymin, dbl h,
+          py::array_t<int, py::array::c_style | py::array::forcecast>
+            const & sources,
+          dbl r) {
+        if (sources.ndim() != 2 || sources.shape(1) != 2) {
+          throw std::invalid_argument {"sources must be an n by 2 array"};
+        }
+        if (shape[0] < 2 || shape[1] < 2) {
+          throw std::invalid_argument {"shape must be at least 2 by 2"};
+        }
+        if (!(h > 0)) {
+          throw std::invalid_argument {"h must be positive"};
+        }
+        if (!(r >= 2)) {
+          throw std::invalid_argument {"r must be at least 2"};
+        }
+        auto src = sources.unchecked<2>();
+        for (py::ssize_t k = 0; k < src.shape(0); ++k) {
+          if (src(k, 0) < 0 || src(k, 0) >= shape[0] ||
+              src(k, 1) < 0 || src(k, 1) >= shape[1]) {
+            throw std::out_of_range {"source out of range"};
+          }
+        }
+        int n = sources.shape(0);
+        py::array_t<dbl> T({n, shape[0], shape[1]});
+        py::array_t<dbl> Tx({n, shape[0], shape[1]});
+        py::array_t<dbl> Ty({n, shape[0], shape[1]});
+        ivec2 const * sources_ptr = (ivec2 const *) sources.data();
+        jet_ptrs_s out {
+          T.mutable_data(), Tx.mutable_data(), Ty.mutable_data(), nullptr
+        };
+        {
+          // See "solve_parallel"
+          py::gil_scoped_release release;
+          eik_batch(&slow.field, {shape[0], shape[1]}, {xymin[0], xymin[1]},
+                    h, n, sources_ptr, r, out);
+        }
+        return std::make_tuple(T, Tx, Ty);
+      },
+      R"pbdoc(
+Solve a point source problem on the same grid with the same slowness
+for each of the nodes (i, j) in sources (an n by 2 array), in
+parallel. Each source is initialized using a disk of radius r >= 2
+nodes. Returns T, Tx, and Ty as n by shape[0] by shape[1] arrays.
+Raises ValueError if shape is smaller than 2 by 2, h isn't positive,
+or r < 2, and IndexError if a source isn't on the grid.
+)pbdoc",
+      py::arg("slow"), py::arg("shape"), py::arg("xymin"), py::arg("h"),
+      py::arg("sources"), py::arg("r") = 2.0
     )
     .def(
       "add_trial",
@@ -314,6 +588,14 @@ TODO!
         eik_make_bd(w.ptr, ivec2 {i, j});
       }
     )
+    .def(
+      "reset",
+      [] (eik_wrapper const & w) { eik_reset(w.ptr); },
+      R"pbdoc(
+Reset every node to Far so that this Eik can be reused to solve a new
+problem. Only the nodes touched by the last solve are visited.
+)pbdoc"
+    )
     .def_readonly("slow", &eik_wrapper::slow)
     .def_property_readonly(
       "shape",
@@ -325,6 +607,22 @@ TODO!
         return eik_get_jet(w.ptr, {i, j});
       }
     )
+    .def_property_readonly(
+      "T_values",
+      [] (py::object obj) { return get_jet_values(obj, &jet_ptrs::f); }
+    )
+    .def_property_readonly(
+      "Tx_values",
+      [] (py::object obj) { return get_jet_values(obj, &jet_ptrs::fx); }
+    )
+    .def_property_readonly(
+      "Ty_values",
+      [] (py::object obj) { return get_jet_values(obj, &jet_ptrs::fy); }
+    )
+    .def_property_readonly(
+      "Txy_values",
+      [] (py::object obj) { return get_jet_values(obj, &jet_ptrs::fxy); }
+    )
     .def(
       "get_state",
       [] (eik_wrapper const & w, int i, int j) {
@@ -335,11 +633,21 @@ TODO!
       "states",
       [] (eik_wrapper const & w) {
         ivec2 shape = eik_get_shape(w.ptr);
+#if ORDERING == TILED_ORDERING
+        // Tiled storage can't be viewed using strides, so return a copy
+        std::vector<state> states(shape.i*shape.j);
+        for (int i = 0; i < shape.i; ++i)
+          for (int j = 0; j < shape.j; ++j)
+            states[shape.j*i + j] = eik_get_state(w.ptr, {i, j});
+        return py::array {{shape.i, shape.j}, states.data()};
+#else
+        ivec2 strides = eik_get_strides(w.ptr);
         return py::array {
           {shape.i, shape.j},
-          {sizeof(state)*shape.j, sizeof(state)},
+          {sizeof(state)*strides.i, sizeof(state)*strides.j},
           eik_get_states_ptr(w.ptr)
         };
+#endif
       }
     )
     .def(
@@ -366,6 +674,54 @@ TODO!
         return eik_Txy(w.ptr, dvec2 {x, y});
       }
     )
+    .def(
+      "T_batch",
+      [] (eik_wrapper const & w, points_t const & xy) {
+        return query_batch(w, xy, eik_T_batch);
+      },
+      "Evaluate T at each point in the n by 2 array `xy`.",
+      py::arg("xy")
+    )
+    .def(
+      "Tx_batch",
+      [] (eik_wrapper const & w, points_t const & xy) {
+        return query_batch(w, xy, eik_Tx_batch);
+      },
+      py::arg("xy")
+    )
+    .def(
+      "Ty_batch",
+      [] (eik_wrapper const & w, points_t const & xy) {
+        return query_batch(w, xy, eik_Ty_batch);
+      },
+      py::arg("xy")
+    )
+    .def(
+      "Txy_batch",
+      [] (eik_wrapper const & w, points_t const & xy) {
+        return query_batch(w, xy, eik_Txy_batch);
+      },
+      py::arg("xy")
+    )
+    .def(
+      "jet_batch",
+      [] (eik_wrapper const & w, points_t const & xy) {
+        int n = get_num_points(xy);
+        py::array_t<dbl> jets({n, 4});
+        dvec2 const * xy_ptr = (dvec2 const *) xy.data();
+        jet_s * jets_ptr = (jet_s *) jets.mutable_data();
+        {
+          py::gil_scoped_release release;
+          eik_jet_batch(w.ptr, xy_ptr, n, jets_ptr);
+        }
+        return jets;
+      },
+      R"pbdoc(
+Evaluate T, Tx, Ty, and Txy at each point in the n by 2 array `xy` in
+one pass. Returns an n by 4 array whose columns are T, Tx, Ty, and Txy.
+)pbdoc",
+      py::arg("xy")
+    )
     .def(
       "can_build_cell",
       [] (eik_wrapper const & w, int i, int j) {
@@ -386,11 +742,22 @@ TODO!
       "bicubics",
       [] (eik_wrapper const & w) {
         ivec2 shape = eik_get_shape(w.ptr);
+#if ORDERING == TILED_ORDERING || CELL_STORAGE == BAND_CELL_STORAGE
+        // Tiled storage can't be viewed using strides, and band storage
+        // only keeps some of the cells, so return a copy instead
+        std::vector<bicubic> bicubics((shape.i - 1)*(shape.j - 1));
+        for (int i = 0; i < shape.i - 1; ++i)
+          for (int j = 0; j < shape.j - 1; ++j)
+            bicubics[(shape.j - 1)*i + j] = eik_get_bicubic(w.ptr, {i, j});
+        return py::array {{shape.i - 1, shape.j - 1}, bicubics.data()};
+#else
+        ivec2 strides = eik_get_cell_strides(w.ptr);
         return py::array {
           {shape.i - 1, shape.j - 1},
-          {sizeof(bicubic)*(shape.j - 1), sizeof(bicubic)},
+          {sizeof(bicubic)*strides.i, sizeof(bicubic)*strides.j},
           eik_get_bicubics_ptr(w.ptr)
         };
+#endif
       }
     )
     .def_property_readonly(
@@ -399,6 +766,47 @@ TODO!
         return heap_wrapper {eik_get_heap(w.ptr)};
       }
     )
+    .def_property(
+      "use_newton",
+      [] (eik_wrapper const & w) { return eik_get_use_newton(w.ptr); },
+      [] (eik_wrapper & w, bool use_newton) {
+        eik_set_use_newton(w.ptr, use_newton);
+      }
+    )
+    .def_property(
+      "use_warm_start",
+      [] (eik_wrapper const & w) { return eik_get_use_warm_start(w.ptr); },
+      [] (eik_wrapper & w, bool use_warm_start) {
+        eik_set_use_warm_start(w.ptr, use_warm_start);
+      }
+    )
+    .def_property(
+      "s_min",
+      [] (eik_wrapper const & w) { return eik_get_s_min(w.ptr); },
+      [] (eik_wrapper & w, dbl s_min) { eik_set_s_min(w.ptr, s_min); }
+    )
+    .def_property(
+      "parallel_updates",
+      [] (eik_wrapper const & w) { return eik_get_parallel_updates(w.ptr); },
+      [] (eik_wrapper & w, bool parallel_updates) {
+        eik_set_parallel_updates(w.ptr, parallel_updates);
+      }
+    )
+    .def_property_readonly(
+      "stats",
+      [] (eik_wrapper const & w) { return eik_get_stats(w.ptr); }
+    )
+    ;
+
+  py::class_<eik_stats_s>(m, "EikStats")
+    .def_readonly("num_line_updates", &eik_stats_s::num_line_updates)
+    .def_readonly("num_tri_updates", &eik_stats_s::num_tri_updates)
+    .def_readonly("num_bfgs_iters", &eik_stats_s::num_bfgs_iters)
+    .def_readonly("num_warm_starts", &eik_stats_s::num_warm_starts)
+    .def_readonly("num_pruned_line_updates",
+                  &eik_stats_s::num_pruned_line_updates)
+    .def_readonly("num_pruned_tri_updates",
+                  &eik_stats_s::num_pruned_tri_updates)
     ;
 
   // field.h
@@ -406,8 +814,61 @@ TODO!
   py::class_<field2_wrapper>(m, "Field2")
     .def(py::init<
            std::function<dbl(dbl, dbl)> const &,
-           std::function<std::array<dbl, 2>(dbl, dbl)> const &
-         >())
+           std::function<std::array<dbl, 2>(dbl, dbl)> const &,
+           decltype(field2_wrapper::hess_f) const &
+         >(),
+         py::arg("f"), py::arg("grad_f"), py::arg("hess_f") = py::none())
+    .def_static(
+      "from_array",
+      [] (py::array_t<dbl, py::array::c_style | py::array::forcecast> values,
+          std::array<dbl, 2> const & xymin, dbl h) {
+        if (values.ndim() != 2) {
+          throw std::invalid_argument {"values must be a 2D array"};
+        }
+        ivec2 shape {(int) values.shape(0), (int) values.shape(1)};
+        if (shape.i < 3 || shape.j < 3) {
+          throw std::invalid_argument {"values must be at least 3x3"};
+        }
+        field2_tab * ptr;
+        field2_tab_alloc(&ptr);
+        field2_tab_init(ptr, shape, {xymin[0], xymin[1]}, h, values.data());
+        std::shared_ptr<field2_tab> tab {ptr, [] (field2_tab * ptr) {
+          field2_tab_deinit(ptr);
+          field2_tab_dealloc(&ptr);
+        }};
+        return field2_wrapper {field2_tab_get_field2(tab.get()), tab};
+      },
+      R"pbdoc(
+Make a Field2 which interpolates `values`, sampled on a grid with
+spacing `h` whose lower-left corner is `xymin`, using bicubics. So,
+values[i, j] is the value at (xymin[0] + h*i, xymin[1] + h*j). This
+is evaluated natively, which is much faster than calling back into
+Python.
+)pbdoc",
+      py::arg("values"), py::arg("xymin"), py::arg("h"))
+    .def_static(
+      "constant",
+      [] (dbl s) {
+        auto ptr = std::make_shared<dbl>(s);
+        return field2_wrapper {field2_constant(ptr.get()), ptr};
+      },
+      "Make a Field2 equal to `s` everywhere, evaluated natively.",
+      py::arg("s") = 1.0)
+    .def_static(
+      "linear_speed",
+      [] (dbl vx, dbl vy) {
+        auto ptr = std::make_shared<dvec2>(dvec2 {vx, vy});
+        return field2_wrapper {field2_linear_speed(ptr.get()), ptr};
+      },
+      R"pbdoc(
+Make a Field2 for the slowness s = 1/c of the linear speed function
+c(x, y) = 1 + vx*x + vy*y, evaluated natively.
+)pbdoc",
+      py::arg("vx"), py::arg("vy"))
+    .def_property_readonly(
+      "native",
+      [] (field2_wrapper const & wrap) { return wrap.native != nullptr; }
+    )
     .def(
       "s",
       [] (field2_wrapper const & wrap, dbl x, dbl y) {
@@ -420,6 +881,16 @@ TODO!
         return field2_grad_f(&wrap.field, {x, y});
       }
     )
+    .def_property_readonly(
+      "has_hess",
+      [] (field2_wrapper const & wrap) { return field2_has_hess(&wrap.field); }
+    )
+    .def(
+      "hess_s",
+      [] (field2_wrapper const & wrap, dbl x, dbl y) {
+        return field2_hess_f(&wrap.field, {x, y});
+      }
+    )
     ;
 
   // heap.h
@@ -434,12 +905,18 @@ TODO!
       "swim",
       [] (heap_wrapper & w, int ind) { heap_swim(w.ptr, ind); }
     )
+    .def(
+      "update_key",
+      [] (heap_wrapper & w, int pos, dbl key) {
+        heap_update_key(w.ptr, pos, key);
+      }
+    )
     .def_property_readonly(
       "front",
       [] (heap_wrapper const & w) {
         std::optional<int> l0;
         if (heap_size(w.ptr) > 0) {
-          *l0 = heap_front(w.ptr);
+          l0 = heap_front(w.ptr);
         }
         return l0;
       }
@@ -452,6 +929,15 @@ TODO!
       "size",
       [] (heap_wrapper const & w) { return heap_size(w.ptr); }
     )
+    .def_property(
+      "arity",
+      [] (heap_wrapper const & w) { return heap_get_arity(w.ptr); },
+      [] (heap_wrapper & w, int arity) { heap_set_arity(w.ptr, arity); }
+    )
+    .def(
+      "use_buckets",
+      [] (heap_wrapper & w, dbl width) { heap_use_buckets(w.ptr, width); }
+    )
     ;
 
   // hybrid.h
@@ -464,6 +950,18 @@ TODO!
     }
   );
 
+  // newton.h
+
+  m.def(
+    "newton",
+    [] (std::function<std::pair<dbl, dbl>(dbl)> const & f, dbl a, dbl b,
+        dbl x) {
+      void * context = (void *) &f;
+      return newton(f_df_wrapper, a, b, x, context);
+    },
+    py::arg("f"), py::arg("a"), py::arg("b"), py::arg("x") = NAN
+  );
+
   // index.h
 
   m.def(
@@ -540,7 +1038,7 @@ TODO!
     "_xy_to_lc_and_cc",
     [] (std::array<int, 2> shape, std::array<dbl, 2> xymin, dbl h,
         std::array<dbl, 2> xy) {
-      dvec2 cc;
+      dvec2 cc = {NAN, NAN};
       int lc = xy_to_lc_and_cc(
         {shape[0], shape[1]},
         {xymin[0], xymin[1]},
@@ -719,13 +1217,22 @@ TODO!
              ptr->xy0 = xy0;
              ptr->xy1 = xy1;
              ptr->slow = &slow.field;
+             ptr->s = field2_f(&slow.field, xy);
              ptr->F3 = NAN;
              ptr->F3_eta = NAN;
              return ptr;
            }
          ))
     .def_readwrite("T_cubic", &F3_context::T_cubic)
-    .def_readwrite("xy", &F3_context::xy)
+    .def_property(
+      "xy",
+      [] (F3_context const & context) { return context.xy; },
+      // Keep the slowness at xy up to date
+      [] (F3_context & context, dvec2 const & xy) {
+        context.xy = xy;
+        context.s = field2_f(context.slow, xy);
+      }
+    )
     .def_readwrite("xy0", &F3_context::xy0)
     .def_readwrite("xy1", &F3_context::xy1)
     .def(
@@ -751,6 +1258,7 @@ TODO!
              ptr->xy0 = xy0;
              ptr->xy1 = xy1;
              ptr->slow = &slow.field;
+             ptr->s = field2_f(&slow.field, xy);
              ptr->F4 = NAN;
              ptr->F4_eta = NAN;
              ptr->F4_th = NAN;
@@ -760,7 +1268,14 @@ TODO!
     .def_readwrite("T_cubic", &F4_context::T_cubic)
     .def_readwrite("Tx_cubic", &F4_context::Tx_cubic)
     .def_readwrite("Ty_cubic", &F4_context::Ty_cubic)
-    .def_readwrite("xy", &F4_context::xy)
+    .def_property(
+      "xy",
+      [] (F4_context const & context) { return context.xy; },
+      [] (F4_context & context, dvec2 const & xy) {
+        context.xy = xy;
+        context.s = field2_f(context.slow, xy);
+      }
+    )
     .def_readwrite("xy0", &F4_context::xy0)
     .def_readwrite("xy1", &F4_context::xy1)
     .def(
@@ -769,6 +1284,33 @@ TODO!
         F4_compute(eta, th, &context);
       }
     )
+    .def(
+      "compute_hess",
+      [] (F4_context & context, dbl eta, dbl th) {
+        F4_compute_hess(eta, th, &context);
+      }
+    )
+    .def(
+      "compute_batch",
+      [] (F4_context const & context, std::vector<dbl> const & eta,
+          std::vector<dbl> const & th) {
+        if (eta.size() != th.size() || eta.size() > F4_MAX_BATCH) {
+          throw std::runtime_error {
+            "eta and th must have the same length, at most F4_MAX_BATCH"
+          };
+        }
+        int n = eta.size();
+        std::vector<dbl> F4(n);
+        std::vector<dvec2> grad(n);
+        F4_compute_batch(n, eta.data(), th.data(), &context, F4.data(),
+                         grad.data());
+        return std::make_tuple(F4, grad);
+      }
+    )
+    .def_property_readonly(
+      "hess",
+      [] (F4_context const & context) { return F4_get_hess(&context); }
+    )
     .def(
       "hess_fd",
       [] (F4_context & context, dbl eta, dbl th, dbl eps = 1e-7) {
@@ -794,6 +1336,16 @@ TODO!
           xk1, gk1, Hk1);
       }
     )
+    .def(
+      "newton_step",
+      [] (F4_context & context, dvec2 xk, dvec2 gk, dmat22 Hk) {
+        dvec2 xk1, gk1;
+        dmat22 Hk1;
+        return std::make_tuple(
+          F4_newton_step(xk, gk, Hk, &xk1, &gk1, &Hk1, &context),
+          xk1, gk1, Hk1);
+      }
+    )
     .def_readonly("F4", &F4_context::F4)
     .def_readonly("F4_eta", &F4_context::F4_eta)
     .def_readonly("F4_th", &F4_context::F4_th)
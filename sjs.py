@@ -21,7 +21,7 @@ def get_constant_slowness_field2():
 \equiv = 1$.
 
     '''
-    return Field2(lambda x, y: 1.0, lambda x, y: (0.0, 0.0))
+    return Field2.constant(1.0)
 
 def get_linear_speed_field2(vx, vy):
     '''Get a Field2 instance corresponding to a slowness function
@@ -29,5 +29,4 @@ representing the linear speed function $c(x, y) = 1 + \texttt{vx}
 \cdot x + \texttt{vy} \cdot y$ (note that $s \equiv 1/c$.
 
     '''
-    s = lambda x, y: 1.0/(1.0 + vx*x + vy*y)
-    return Field2(s, lambda x, y: (-vx*s(x, y)**2, -vy*s(x, y)**2))
+    return Field2.linear_speed(vx, vy)
@@ -15,6 +15,16 @@ class TestBicubic(unittest.TestCase):
                 self.assertAlmostEqual(bicubic.fy(lam, mu), data[i, 2 + j])
                 self.assertAlmostEqual(bicubic.fxy(lam, mu), data[2 + i, 2 + j])
 
+    def test_A(self):
+        for _ in range(10):
+            data = np.random.randn(4, 4)
+            bicubic = sjs.Bicubic(data)
+            A = np.array(bicubic.A)
+            for _ in range(10):
+                lam, mu = np.random.rand(2)
+                m = lambda t: np.array([1, t, t**2, t**3])
+                self.assertAlmostEqual(bicubic.f(lam, mu), m(lam)@A@m(mu))
+
     def test_get_f_on_edge(self):
         for _ in range(10):
             data = np.random.randn(4, 4)
@@ -122,6 +132,23 @@ class TestBicubic(unittest.TestCase):
                 mu = np.random.rand()
                 self.assertAlmostEqual(cubic.f(mu), bicubic.fy(1, mu))
 
+    def test_get_cubics_on_edge(self):
+        variables = [sjs.BicubicVariable.Lambda, sjs.BicubicVariable.Mu]
+        for _ in range(10):
+            bicubic = sjs.Bicubic(np.random.randn(4, 4))
+            for var, edge, reverse in it.product(variables, [0, 1], [False, True]):
+                cubics = bicubic.get_cubics_on_edge(var, edge, reverse)
+                expected = [
+                    bicubic.get_f_on_edge(var, edge),
+                    bicubic.get_fx_on_edge(var, edge),
+                    bicubic.get_fy_on_edge(var, edge)
+                ]
+                for cubic, other in zip(cubics, expected):
+                    for _ in range(5):
+                        t = np.random.rand()
+                        s = 1 - t if reverse else t
+                        self.assertAlmostEqual(cubic.f(t), other.f(s))
+
     def test_interpolate_fxy_at_verts(self):
         fx = np.zeros(4)
         fy = np.zeros(4)
@@ -2,8 +2,50 @@ import numpy as np
 import sjs
 import unittest
 
+from concurrent.futures import ThreadPoolExecutor
+
 # TODO: definitely need to add some more tests here!
 
+def get_point_source_eik(N, eik=None, src=None, slow=None):
+    '''Set up an N by N Eik on [-1, 1]^2 with s = 1 and exact
+initial data in a small disk around the center, ready to solve. If
+eik is passed, it's reused instead of creating a new Eik. If src = (i,
+j, di, dj) is passed, the disk is centered at node (i, j) instead, and
+the source is moved off the grid to (i + di, j + dj), which breaks the
+symmetry of the problem. If slow is passed, it's used instead of s =
+1, and the initial data assumes the rays near the source are straight
+(like `add_point_source` in eik.c), which is only exact for s = 1.'''
+    shape, xymin, h = (N, N), (-1, -1), 2/(N - 1)
+    if slow is None:
+        slow = sjs.get_constant_slowness_field2()
+    i0, j0, di, dj = (N//2, N//2, 0, 0) if src is None else src
+    x0, y0 = xymin[0] + h*(i0 + di), xymin[1] + h*(j0 + dj)
+    s0 = slow.s(x0, y0)
+
+    def get_jet(i, j):
+        x, y = xymin[0] + h*i, xymin[1] + h*j
+        dx, dy = x - x0, y - y0
+        r = np.sqrt(dx**2 + dy**2)
+        if r == 0:
+            return sjs.Jet(0, 0, 0, 0)
+        s, grad_s = slow.s(x, y), slow.grad_s(x, y)
+        return sjs.Jet(r*(s0 + s)/2, s*dx/r, s*dy/r,
+                       grad_s.y*dx/r - s*dx*dy/r**3)
+
+    if eik is None:
+        eik = sjs.Eik(slow, shape, xymin, h)
+    for i in range(N):
+        for j in range(N):
+            if (i - i0)**2 + (j - j0)**2 <= 4:
+                eik.add_valid(i, j, get_jet(i, j))
+    for i in range(N):
+        for j in range(N):
+            if eik.get_state(i, j) == sjs.State.Far and \
+               (i - i0)**2 + (j - j0)**2 <= 9:
+                eik.add_trial(i, j, get_jet(i, j))
+    eik.build_cells()
+    return eik
+
 class TestEik(unittest.TestCase):
     def test_set_jet(self):
         shape = (2, 2)
@@ -17,5 +59,280 @@ class TestEik(unittest.TestCase):
         eik.add_trial(1, 1, sjs.Jet(1, 0, 0, 0))
         self.assertFalse(eik.can_build_cell(0, 0))
 
+    def test_jet_values(self):
+        shape = (5, 4)
+        xymin = (0, 0)
+        h = 1
+        slow = sjs.get_constant_slowness_field2()
+        eik = sjs.Eik(slow, shape, xymin, h)
+        eik.add_valid(2, 1, sjs.Jet(1, 2, 3, 4))
+        eik.add_trial(4, 3, sjs.Jet(5, 6, 7, 8))
+        T, Tx = eik.T_values, eik.Tx_values
+        Ty, Txy = eik.Ty_values, eik.Txy_values
+        self.assertEqual(T.shape, shape)
+        for i in range(shape[0]):
+            for j in range(shape[1]):
+                jet = eik.get_jet(i, j)
+                np.testing.assert_equal(T[i, j], jet.f)
+                np.testing.assert_equal(Tx[i, j], jet.fx)
+                np.testing.assert_equal(Ty[i, j], jet.fy)
+                np.testing.assert_equal(Txy[i, j], jet.fxy)
+        self.assertEqual(T[2, 1], 1)
+        self.assertEqual(Txy[4, 3], 8)
+
+    def test_solve_in_threads(self):
+        # A native field lets solve() release the GIL, so solving on
+        # separate threads should give the same results as solving
+        # serially.
+        eik = get_point_source_eik(21)
+        eik.solve()
+
+        eiks = [get_point_source_eik(21) for _ in range(4)]
+        with ThreadPoolExecutor(len(eiks)) as executor:
+            list(executor.map(lambda eik: eik.solve(), eiks))
+        for other in eiks:
+            np.testing.assert_equal(other.T_values, eik.T_values)
+
+    def test_solve_parallel(self):
+        # Use a source which isn't symmetric about any line through the
+        # grid, since the tiles could break ties between mirrored nodes
+        # differently. The tiles don't warm start, so neither does the
+        # serial solver.
+        src = (27, 9, 0.3, 0.17)
+        eik = get_point_source_eik(33, src=src)
+        eik.use_warm_start = False
+        eik.solve()
+        for num_tiles in [(1, 1), (2, 3), (4, 4), (8, 8)]:
+            other = get_point_source_eik(33, src=src)
+            other.solve_parallel(num_tiles)
+            self.assertTrue((other.states == sjs.State.Valid).all())
+            np.testing.assert_allclose(
+                other.T_values, eik.T_values, rtol=1e-12)
+            np.testing.assert_allclose(
+                other.Txy_values, eik.Txy_values, rtol=1e-8, atol=1e-8)
+
+    def test_parallel_updates(self):
+        eik = get_point_source_eik(33)
+        eik.solve()
+        other = get_point_source_eik(33)
+        other.parallel_updates = True
+        other.solve()
+        self.assertTrue((other.T_values == eik.T_values).all())
+        self.assertTrue((other.Txy_values == eik.Txy_values).all())
+
+    def test_warm_start(self):
+        eik = get_point_source_eik(33)
+        self.assertTrue(eik.use_warm_start)
+        eik.solve()
+        other = get_point_source_eik(33)
+        other.use_warm_start = False
+        other.solve()
+        self.assertGreater(eik.stats.num_warm_starts, 0)
+        self.assertEqual(other.stats.num_warm_starts, 0)
+        self.assertLess(eik.stats.num_bfgs_iters, other.stats.num_bfgs_iters)
+        np.testing.assert_allclose(other.T_values, eik.T_values, rtol=1e-10)
+
+    def test_s_min(self):
+        # Pruning only skips updates which can't improve T, so the
+        # solution shouldn't change. (Skipped triangle updates don't
+        # leave warm starts behind, so turn those off.)
+        eik = get_point_source_eik(33)
+        self.assertEqual(eik.s_min, 0)
+        eik.use_warm_start = False
+        eik.solve()
+        other = get_point_source_eik(33)
+        other.use_warm_start = False
+        other.s_min = 1
+        other.solve()
+        self.assertTrue((other.T_values == eik.T_values).all())
+        self.assertTrue((other.Txy_values == eik.Txy_values).all())
+        stats, other_stats = eik.stats, other.stats
+        self.assertGreater(
+            other_stats.num_pruned_line_updates, stats.num_pruned_line_updates)
+        self.assertEqual(
+            stats.num_line_updates + stats.num_pruned_line_updates,
+            other_stats.num_line_updates + other_stats.num_pruned_line_updates)
+        self.assertEqual(
+            stats.num_tri_updates + stats.num_pruned_tri_updates,
+            other_stats.num_tri_updates + other_stats.num_pruned_tri_updates)
+
+    def test_reset(self):
+        eik = get_point_source_eik(33)
+        eik.solve()
+        eik.reset()
+        for i in range(33):
+            for j in range(33):
+                self.assertEqual(eik.get_state(i, j), sjs.State.Far)
+        self.assertTrue(np.isinf(eik.T_values).all())
+        get_point_source_eik(33, eik).solve()
+        other = get_point_source_eik(33)
+        other.solve()
+        self.assertTrue((other.T_values == eik.T_values).all())
+        self.assertTrue((other.Txy_values == eik.Txy_values).all())
+
+    def test_solve_until_T(self):
+        # Nodes are accepted in the same order as `solve`, so the
+        # nodes which have been accepted should agree exactly.
+        eik = get_point_source_eik(33)
+        eik.solve_until_T(0.5)
+        other = get_point_source_eik(33)
+        other.solve()
+        for i in range(33):
+            for j in range(33):
+                T = other.get_jet(i, j).f
+                if T <= 0.5:
+                    self.assertEqual(eik.get_state(i, j), sjs.State.Valid)
+                    self.assertEqual(eik.get_jet(i, j).f, T)
+                else:
+                    self.assertNotEqual(eik.get_state(i, j), sjs.State.Valid)
+
+    def test_solve_until_targets(self):
+        targets = np.array([[20, 12], [24, 25]])
+        eik = get_point_source_eik(33)
+        eik.solve_until_targets(targets)
+        other = get_point_source_eik(33)
+        other.solve()
+        for i, j in targets:
+            for di in range(-1, 2):
+                for dj in range(-1, 2):
+                    self.assertEqual(
+                        eik.get_state(i + di, j + dj), sjs.State.Valid)
+            self.assertEqual(eik.get_jet(i, j).f, other.get_jet(i, j).f)
+        self.assertEqual(eik.get_state(0, 0), sjs.State.Far)
+
+    def test_solve_fim(self):
+        # The FIM solver accepts nodes in a different order, so it
+        # doesn't agree with `solve` to round-off, but it should be
+        # about as accurate
+        N = 33
+        x = np.linspace(-1, 1, N)
+        r = np.sqrt(np.add.outer(x**2, x**2))
+        eik = get_point_source_eik(N)
+        eik.solve()
+        other = get_point_source_eik(N)
+        other.solve_fim()
+        self.assertTrue((other.states == sjs.State.Valid).all())
+        error = abs(eik.T_values - r).max()
+        self.assertLess(abs(other.T_values - r).max(), 2*error)
+
+        # With a rough slowness, some nodes are accepted before `solve`
+        # would have updated them from each other, so the difference is
+        # larger, but it should still go down with h (the error of
+        # `solve` itself is about 5e-3 for N = 33).
+        diffs = []
+        for N in [33, 65]:
+            x = np.linspace(-1, 1, N)
+            X, Y = np.meshgrid(x, x, indexing='ij')
+            s = 1 + 0.1*np.sin(4*np.pi*X)*np.sin(4*np.pi*Y)
+            slow = sjs.Field2.from_array(s, (-1, -1), 2/(N - 1))
+            eik = get_point_source_eik(N, slow=slow)
+            eik.solve()
+            other = get_point_source_eik(N, slow=slow)
+            other.solve_fim()
+            self.assertTrue((other.states == sjs.State.Valid).all())
+            diffs.append(abs(other.T_values - eik.T_values).max())
+        self.assertLess(diffs[0], 1e-3)
+        self.assertLess(diffs[1], diffs[0]/2)
+
+    def test_solve_sweep(self):
+        # Sweeping doesn't warm start, so neither does the serial
+        # solver. Check a source which isn't symmetric about any line
+        # through the grid, too.
+        for src in [None, (27, 9, 0.3, 0.17)]:
+            eik = get_point_source_eik(33, src=src)
+            eik.use_warm_start = False
+            eik.solve()
+            for num_tiles in [(1, 1), (2, 3)]:
+                other = get_point_source_eik(33, src=src)
+                self.assertTrue(other.solve_sweep(1e-6, num_tiles))
+                self.assertTrue((other.states == sjs.State.Valid).all())
+                np.testing.assert_allclose(
+                    other.T_values, eik.T_values, rtol=0, atol=1e-6)
+
+        # With a rough slowness, sweeping stalls before converging (see
+        # eik_solve_sweep), but T is still well within the difference
+        # between N = 33 and N = 65 (about 2e-3).
+        N = 33
+        x = np.linspace(-1, 1, N)
+        X, Y = np.meshgrid(x, x, indexing='ij')
+        s = 1 + 0.1*np.sin(4*np.pi*X)*np.sin(4*np.pi*Y)
+        slow = sjs.Field2.from_array(s, (-1, -1), 2/(N - 1))
+        eik = get_point_source_eik(N, slow=slow)
+        eik.use_warm_start = False
+        eik.solve()
+        other = get_point_source_eik(N, slow=slow)
+        self.assertIsInstance(other.solve_sweep(1e-6, (2, 3)), bool)
+        self.assertTrue((other.states == sjs.State.Valid).all())
+        self.assertLess(abs(other.T_values - eik.T_values).max(), 1e-3)
+
+    def test_solve_batch(self):
+        N = 17
+        shape, xymin, h = (N, N), (-1, -1), 2/(N - 1)
+        slow = sjs.get_constant_slowness_field2()
+        sources = np.array([[8, 8], [3, 12], [0, 0]])
+        T, Tx, Ty = sjs.Eik.solve_batch(slow, shape, xymin, h, sources)
+        self.assertEqual(T.shape, (len(sources), N, N))
+        x = np.linspace(-1, 1, N)
+        X, Y = np.meshgrid(x, x, indexing='ij')
+        for k, (i0, j0) in enumerate(sources):
+            R = np.sqrt((X - x[i0])**2 + (Y - x[j0])**2)
+            self.assertLess(abs(T[k] - R).max(), 1e-3)
+            mask = R > 0
+            self.assertLess(abs(Tx[k][mask] - (X - x[i0])[mask]/R[mask]).max(),
+                            1e-2)
+
+        # Bad arguments raise instead of tripping asserts in eik_batch
+        args = slow, shape, xymin, h
+        with self.assertRaises(ValueError):
+            sjs.Eik.solve_batch(*args, sources, r=1.5)
+        with self.assertRaises(ValueError):
+            sjs.Eik.solve_batch(slow, (1, N), xymin, h, sources)
+        with self.assertRaises(ValueError):
+            sjs.Eik.solve_batch(slow, shape, xymin, 0.0, sources)
+        with self.assertRaises(ValueError):
+            sjs.Eik.solve_batch(*args, np.array([8, 8]))
+        with self.assertRaises(IndexError):
+            sjs.Eik.solve_batch(*args, np.array([[8, 8], [N, 0]]))
+        with self.assertRaises(IndexError):
+            sjs.Eik.solve_batch(*args, np.array([[-1, 8]]))
+
+    def test_batch_queries(self):
+        N = 6
+        shape, xymin, h = (N, N), (0, 0), 0.5
+        eik = sjs.Eik(sjs.get_constant_slowness_field2(), shape, xymin, h)
+        for i in range(N):
+            for j in range(N):
+                x, y = xymin[0] + h*i, xymin[1] + h*j
+                jet = sjs.Jet(x**2 + x*y + y**3, 2*x + y, x + 3*y**2, 1)
+                if i < N - 1:
+                    eik.add_valid(i, j, jet)
+                else:
+                    eik.add_trial(i, j, jet)
+        eik.build_cells()
+
+        xy = np.random.uniform(0, h*(N - 1), (100, 2))
+        jets = eik.jet_batch(xy)
+        self.assertEqual(jets.shape, (100, 4))
+        for k, (x, y) in enumerate(xy):
+            np.testing.assert_equal(jets[k, 0], eik.T(x, y))
+            np.testing.assert_equal(jets[k, 1], eik.Tx(x, y))
+            np.testing.assert_equal(jets[k, 2], eik.Ty(x, y))
+            np.testing.assert_equal(jets[k, 3], eik.Txy(x, y))
+        np.testing.assert_equal(eik.T_batch(xy), jets[:, 0])
+        np.testing.assert_equal(eik.Tx_batch(xy), jets[:, 1])
+        np.testing.assert_equal(eik.Ty_batch(xy), jets[:, 2])
+        np.testing.assert_equal(eik.Txy_batch(xy), jets[:, 3])
+
+        # Points outside the grid are clamped to it, however far away
+        # they are, and points which aren't finite give NaN
+        xy = np.array([[-1e300, 1], [1, 1e300], [1e10, -1e10],
+                       [np.nan, 1], [1, np.inf]])
+        xy_clamped = np.clip(xy[:3], 0, h*(N - 1))
+        np.testing.assert_equal(eik.jet_batch(xy)[:3],
+                                eik.jet_batch(xy_clamped))
+        self.assertTrue(np.isnan(eik.jet_batch(xy)[3:]).all())
+        self.assertTrue(np.isnan(eik.T_batch(xy)[3:]).all())
+        self.assertTrue(np.isnan(eik.T(np.nan, 1)))
+
 if __name__ == '__main__':
     unittest.main()
@@ -139,6 +139,94 @@ class TestF4(unittest.TestCase):
                 self.assertAlmostEqual(f4_eta_gt, context.F4_eta)
                 self.assertAlmostEqual(f4_th_gt, context.F4_th)
 
+    def test_hess(self):
+        for _ in range(10):
+            vx, vy = np.random.uniform(-0.05, 0.05, (2,))
+            s_gt = get_linear_speed_s(vx, vy)
+            slow = sjs.get_linear_speed_field2(vx, vy)
+
+            data = np.random.randn(4, 4)
+            h = np.random.random()
+            H = np.diag([1, 1, h, h])
+            data = H@data@H
+
+            p = np.random.randn(2)
+            p0 = p + h*np.random.randn(2)
+            p1 = p + h*np.random.randn(2)
+
+            bicubic = sjs.Bicubic(data)
+            T = bicubic.get_f_on_edge(sjs.BicubicVariable.Lambda, 0)
+            Tx = bicubic.get_fx_on_edge(sjs.BicubicVariable.Lambda, 0)
+            Ty = bicubic.get_fy_on_edge(sjs.BicubicVariable.Lambda, 0)
+
+            a_T = np.array([T.a[i] for i in range(4)])
+            a_Tx = np.array([Tx.a[i] for i in range(4)])
+            a_Ty = np.array([Ty.a[i] for i in range(4)])
+
+            context_gt = F4(s_gt, a_T, a_Tx, a_Ty, p, p0, p1)
+
+            xy = sjs.Dvec2(*p)
+            xy0 = sjs.Dvec2(*p0)
+            xy1 = sjs.Dvec2(*p1)
+
+            context = sjs.F4Context(T, Tx, Ty, xy, xy0, xy1, slow)
+
+            for _ in range(10):
+                args = np.random.random(2)
+                args[1] *= 2*np.pi
+
+                context.compute_hess(*args)
+
+                hess_gt = context_gt.hess_F4(args)
+
+                self.assertAlmostEqual(hess_gt[0, 0], context.hess[0, 0])
+                self.assertAlmostEqual(hess_gt[0, 1], context.hess[0, 1])
+                self.assertAlmostEqual(hess_gt[1, 0], context.hess[1, 0])
+                self.assertAlmostEqual(hess_gt[1, 1], context.hess[1, 1])
+
+    def test_compute_batch(self):
+        vx, vy = np.random.uniform(-0.05, 0.05, (2,))
+        s_gt = get_linear_speed_s(vx, vy)
+        grad_s_gt = lambda x, y: (-vx*s_gt(x, y)**2, -vy*s_gt(x, y)**2)
+
+        # Use the native field, which evaluates batches at once, and a
+        # Python one, which doesn't
+        slows = [
+            sjs.get_linear_speed_field2(vx, vy),
+            sjs.Field2(s_gt, grad_s_gt)
+        ]
+
+        for slow in slows:
+            data = np.random.randn(4, 4)
+            h = np.random.random()
+            H = np.diag([1, 1, h, h])
+            data = H@data@H
+
+            p = np.random.randn(2)
+            p0 = p + h*np.random.randn(2)
+            p1 = p + h*np.random.randn(2)
+
+            bicubic = sjs.Bicubic(data)
+            T = bicubic.get_f_on_edge(sjs.BicubicVariable.Lambda, 0)
+            Tx = bicubic.get_fx_on_edge(sjs.BicubicVariable.Lambda, 0)
+            Ty = bicubic.get_fy_on_edge(sjs.BicubicVariable.Lambda, 0)
+
+            xy = sjs.Dvec2(*p)
+            xy0 = sjs.Dvec2(*p0)
+            xy1 = sjs.Dvec2(*p1)
+
+            context = sjs.F4Context(T, Tx, Ty, xy, xy0, xy1, slow)
+
+            for n in range(1, 9):
+                eta = np.random.random(n)
+                th = 2*np.pi*np.random.random(n)
+                F4, grad = context.compute_batch(list(eta), list(th))
+                for i in range(n):
+                    context.compute(eta[i], th[i])
+                    self.assertEqual(F4[i], context.F4)
+                    self.assertEqual(grad[i].x, context.F4_eta)
+                    self.assertEqual(grad[i].y, context.F4_th)
+
     def test_bfgs_linear_speed(self):
         for _ in range(10):
             h = 0.1
@@ -0,0 +1,51 @@
+import numpy as np
+import sjs
+import unittest
+
+class TestField2(unittest.TestCase):
+
+    def test_from_array_reproduces_quadratic(self):
+        # Finite differences and bicubic interpolation are both exact
+        # for quadratics, so the tabulated field should be, too.
+        a = np.random.uniform(-0.1, 0.1, (5,))
+        s = lambda x, y: \
+            1 + a[0]*x + a[1]*y + a[2]*x**2 + a[3]*x*y + a[4]*y**2
+        grad_s = lambda x, y: \
+            (a[0] + 2*a[2]*x + a[3]*y, a[1] + a[3]*x + 2*a[4]*y)
+        hess_s = lambda x, y: ((2*a[2], a[3]), (a[3], 2*a[4]))
+
+        shape, xymin, h = (11, 7), (-1, -0.5), 0.2
+        x = xymin[0] + h*np.arange(shape[0])
+        y = xymin[1] + h*np.arange(shape[1])
+        X, Y = np.meshgrid(x, y, indexing='ij')
+        field = sjs.Field2.from_array(s(X, Y), xymin, h)
+        self.assertTrue(field.has_hess)
+
+        for _ in range(20):
+            x = np.random.uniform(xymin[0], xymin[0] + h*(shape[0] - 1))
+            y = np.random.uniform(xymin[1], xymin[1] + h*(shape[1] - 1))
+            self.assertAlmostEqual(field.s(x, y), s(x, y))
+            grad = field.grad_s(x, y)
+            self.assertAlmostEqual(grad.x, grad_s(x, y)[0])
+            self.assertAlmostEqual(grad.y, grad_s(x, y)[1])
+            hess = field.hess_s(x, y)
+            for i in range(2):
+                for j in range(2):
+                    self.assertAlmostEqual(hess[i, j], hess_s(x, y)[i][j])
+
+    def test_linear_speed(self):
+        vx, vy = np.random.uniform(-0.05, 0.05, (2,))
+        field = sjs.Field2.linear_speed(vx, vy)
+        self.assertTrue(field.native and field.has_hess)
+        for _ in range(20):
+            x, y = np.random.uniform(-1, 1, (2,))
+            s = 1/(1 + vx*x + vy*y)
+            self.assertAlmostEqual(field.s(x, y), s)
+            grad = field.grad_s(x, y)
+            self.assertAlmostEqual(grad.x, -vx*s**2)
+            self.assertAlmostEqual(grad.y, -vy*s**2)
+            hess = field.hess_s(x, y)
+            self.assertAlmostEqual(hess[0, 1], 2*vx*vy*s**3)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,3 +1,4 @@
+import numpy as np
 import sjs
 import unittest
 
@@ -17,5 +18,75 @@ class TestCubic(unittest.TestCase):
         self.assertTrue(heap.size == 0)
         self.assertIsNone(heap.front)
 
+    def test_update_key(self):
+        values = [4, 3, 2, 1]
+        heap_pos = 4 * [-1]
+
+        value = lambda i: values[i]
+
+        def setpos(i, pos):
+            heap_pos[i] = pos
+
+        heap = sjs.Heap(4, value, setpos)
+        for i in range(4):
+            heap.insert(i)
+
+        self.assertEqual(heap.size, 4)
+        self.assertEqual(heap.front, 3)
+
+        values[0] = 0
+        heap.update_key(heap_pos[0], values[0])
+        self.assertEqual(heap.front, 0)
+
+        heap.pop()
+        self.assertEqual(heap.front, 3)
+
+    def test_arity(self):
+        values = list(np.random.permutation(100))
+        heap_pos = 100 * [-1]
+
+        value = lambda i: values[i]
+
+        def setpos(i, pos):
+            heap_pos[i] = pos
+
+        for arity in [2, 4, 8]:
+            heap = sjs.Heap(4, value, setpos)
+            for i in range(50):
+                heap.insert(i)
+            heap.arity = arity
+            self.assertEqual(heap.arity, arity)
+            for i in range(50, 100):
+                heap.insert(i)
+            popped = []
+            while heap.size > 0:
+                popped.append(values[heap.front])
+                heap.pop()
+            self.assertEqual(popped, sorted(values))
+
+    def test_use_buckets(self):
+        values = list(np.random.permutation(100))
+        heap_pos = 100 * [-1]
+
+        value = lambda i: values[i]
+
+        def setpos(i, pos):
+            heap_pos[i] = pos
+
+        # Since the keys are distinct integers, each bucket will
+        # contain at most one element, so they should be popped in
+        # order.
+        heap = sjs.Heap(4, value, setpos)
+        for i in range(50):
+            heap.insert(i)
+        heap.use_buckets(0.5)
+        for i in range(50, 100):
+            heap.insert(i)
+        popped = []
+        while heap.size > 0:
+            popped.append(values[heap.front])
+            heap.pop()
+        self.assertEqual(popped, sorted(values))
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,46 @@
+import numpy as np
+import sjs
+import unittest
+
+class TestNewton(unittest.TestCase):
+
+    def test_line(self):
+        for _ in range(10):
+            t0 = np.random.rand()
+            f = lambda t: (t - t0, 1)
+            t = sjs.newton(f, 0, 1)
+            self.assertAlmostEqual(t, t0)
+
+    def test_cubic(self):
+        for _ in range(10):
+            t0 = np.random.rand()
+            f = lambda t: ((t - t0)**3, 3*(t - t0)**2)
+            t = sjs.newton(f, 0, 1)
+            self.assertAlmostEqual(t, t0)
+
+    def test_quadratic(self):
+        for _ in range(10):
+            t0 = np.random.rand()
+            f = lambda t: ((t/t0)**2 - 1, 2*t/t0**2)
+            t = sjs.newton(f, 0, 1)
+            self.assertAlmostEqual(t, t0)
+            t = sjs.newton(f, -1, 0)
+            self.assertAlmostEqual(t, -t0)
+
+    def test_agrees_with_hybrid(self):
+        for _ in range(10):
+            t0 = np.random.rand()
+            f = lambda t: np.tanh(10*(t - t0))
+            df = lambda t: 10/np.cosh(10*(t - t0))**2
+            for x in [np.nan, 0.5, np.random.rand()]:
+                t = sjs.newton(lambda t: (f(t), df(t)), 0, 1, x)
+                self.assertAlmostEqual(t, sjs.hybrid(f, 0, 1))
+
+    def test_no_root(self):
+        f = lambda t: (t + 1, 1)
+        self.assertEqual(sjs.newton(f, 0, 1), 0)
+        f = lambda t: (-t - 1, -1)
+        self.assertEqual(sjs.newton(f, 0, 1), 1)
+
+if __name__ == '__main__':
+    unittest.main()